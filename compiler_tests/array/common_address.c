@@ -0,0 +1,33 @@
+int g[16];
+
+int f(int n)
+{
+    int a[16];
+    int i;
+    int j;
+    int k;
+    int s;
+    s = 0;
+    i = 0;
+    while (i < 4) {
+        j = 0;
+        while (j < 4) {
+            a[i*4+j] = i + j + n;
+            g[i*4+j] = a[i*4+j] * 2;
+            g[i*4+j] = g[i*4+j] + a[i*4+j];
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    k = 5;
+    a[k] = a[k] + 1;
+    k = k + 1;
+    a[k] = a[k] + 100;
+    s = a[k-1] + a[k] + (k*n+3) * (k*n+3);
+    i = 0;
+    while (i < 16) {
+        s = s + g[i];
+        i = i + 1;
+    }
+    return s;
+}
@@ -0,0 +1,6 @@
+int f(int n);
+
+int main()
+{
+    return !(f(2)==575 && f(-3)==325);
+}
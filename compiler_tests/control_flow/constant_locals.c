@@ -0,0 +1,29 @@
+int g(int *p)
+{
+    return *p + 1;
+}
+
+int f(int x)
+{
+    int debug = 0;
+    int scale = 3;
+    int limit = scale * 4;
+    int k = 7;
+    int i;
+    int s;
+    s = 0;
+    if (debug) {
+        scale = 100;
+    }
+    for (i = 0; i < limit; i++) {
+        s = s + i * scale + x;
+    }
+    if (limit > 10) {
+        s = s + g(&k);
+    }
+    {
+        int scale = x;
+        s = s + scale;
+    }
+    return s + scale;
+}
@@ -0,0 +1,35 @@
+int counter;
+
+int bump(int x)
+{
+    counter = counter + x;
+    return x;
+}
+
+int f(int n)
+{
+    int unused = n * 3;
+    int sink;
+    int total = 0;
+    int i;
+    sink = bump(2);
+    for(i = 0; i < n; i++) {
+        if(0) {
+            total = total + 100;
+        }
+        else {
+            total = total + i;
+        }
+        if(i == 5) {
+            break;
+            total = total + 1000;
+        }
+        sink = total;
+    }
+    if(1) {
+        total = total + counter;
+        return total;
+    }
+    total = 0;
+    return total;
+}
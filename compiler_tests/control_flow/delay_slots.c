@@ -0,0 +1,26 @@
+int g(int x);
+
+int f(int n)
+{
+    int s;
+    int i;
+    s=0;
+    for(i=0;i<n;i++){
+        if(i>3){
+            s=s+g(i);
+        }
+        else{
+            s=s-1;
+        }
+    }
+    while(n>0){
+        n=n-2;
+        s=s+n;
+    }
+    return s;
+}
+
+int g(int x)
+{
+    return x*2;
+}
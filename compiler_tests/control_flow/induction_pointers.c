@@ -0,0 +1,22 @@
+int f(int n)
+{
+    int a[32];
+    char c[32];
+    int i;
+    int s;
+    s = 0;
+    for(i = 0; i < 32; i++) {
+        a[i] = i * 5 - 7;
+        c[i] = i + 1;
+    }
+    for(i = 0; i < n; i++) {
+        s = s + a[i] * c[i];
+    }
+    for(i = 1; i <= n; i++) {
+        a[i] = a[i] + c[i];
+        if(a[i] > 60) {
+            break;
+        }
+    }
+    return s + a[n] + i;
+}
@@ -0,0 +1,21 @@
+int f(int x, int y)
+{
+    int s;
+    s = 0;
+    while(x < y) {
+        if(((x > 2) && (x != 5))) {
+            s = s + x;
+        }
+        else if(!((x == 0) || (y <= 0))) {
+            s = s + 100;
+        }
+        else {
+            s = s - 1;
+        }
+        x = x + 1;
+    }
+    if(s >= 0) {
+        s = s + 1;
+    }
+    return s;
+}
@@ -0,0 +1,6 @@
+int f(int x, int y);
+
+int main()
+{
+    return !(f(0,8)==320);
+}
@@ -0,0 +1,19 @@
+int scale;
+int hist[8];
+
+int f(int n, int m)
+{
+    int i;
+    int j;
+    int s;
+    s = 0;
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < m; j++) {
+            s = s + n * m + (i * 3 + m) + (j ^ (n << 2)) + scale;
+            hist[j & 7] = hist[j & 7] + 1;
+        }
+        m = m - 1;
+        scale = scale + 2;
+    }
+    return s + hist[1];
+}
@@ -0,0 +1,6 @@
+int f(int n, int m);
+
+int main()
+{
+    return !(f(4,5)==598);
+}
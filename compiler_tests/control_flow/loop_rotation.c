@@ -0,0 +1,29 @@
+int f(int n)
+{
+    int i;
+    int s;
+    s = 0;
+    for(i = 0; i < n; i++) {
+        if(i == 3) {
+            continue;
+        }
+        if(i == 9) {
+            break;
+        }
+        s = s + i;
+    }
+    while(s > 100) {
+        s = s - 7;
+    }
+    while(i < 12) {
+        i++;
+        if(i == 11) {
+            continue;
+        }
+        s = s + 2;
+    }
+    for(i = n; i < 0; i++) {
+        s = s + 1000;
+    }
+    return s;
+}
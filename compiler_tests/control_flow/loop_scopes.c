@@ -0,0 +1,40 @@
+int pick(int a, int b)
+{
+    return a * 3 - b;
+}
+
+int f(int n)
+{
+    int i;
+    int total = 0;
+    for(i = 0; i < n; i++) {
+        int buf[4];
+        int j;
+        for(j = 0; j < 4; j++) {
+            buf[j] = i + j;
+        }
+        if(i == 2) {
+            continue;
+        }
+        {
+            int k = buf[1] + buf[3];
+            total = total + pick(k, buf[0]);
+        }
+        switch(i) {
+            case 5:
+            {
+                int w[2];
+                w[0] = total;
+                w[1] = i;
+                total = w[0] - w[1];
+                break;
+            }
+            default:
+                total = total + 1;
+        }
+        if(total > 500) {
+            break;
+        }
+    }
+    return total;
+}
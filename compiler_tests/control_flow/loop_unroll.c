@@ -0,0 +1,28 @@
+int g(int x)
+{
+    return x + 1;
+}
+
+int f(int n)
+{
+    int a[10];
+    int i;
+    int s;
+    s = 0;
+    for(i = 0; i < 10; i++) {
+        a[i] = i * i;
+    }
+    for(i = 3; i <= 5; i++) {
+        s = s + a[i];
+    }
+    for(i = 0; i < n; i++) {
+        s = s + a[i % 10];
+    }
+    for(i = -2; i <= n; i++) {
+        s = s + g(i);
+    }
+    for(int j = n; j < 3; j++) {
+        s = s + 1000;
+    }
+    return s;
+}
@@ -0,0 +1,39 @@
+int clamp(int v, int lo, int hi)
+{
+    if(v < lo) {
+        return lo;
+    }
+    if(v > hi) {
+        return hi;
+    }
+    return v;
+}
+
+int at(int *p, int i)
+{
+    return p[i];
+}
+
+int swap(int x, int y)
+{
+    int t;
+    t = x;
+    x = y;
+    y = t;
+    return x * 10 + y;
+}
+
+int f(int x, int y)
+{
+    int a[3];
+    int s;
+    int i;
+    a[0] = x;
+    a[1] = y;
+    a[2] = x * y;
+    s = 0;
+    for(i = 0; i < 3; i++) {
+        s = s + clamp(at(a, i), 2, 9) + swap(y, i);
+    }
+    return s;
+}
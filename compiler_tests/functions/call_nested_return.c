@@ -0,0 +1,32 @@
+int h(int a, int b)
+{
+    int i;
+    for(i = 0; i < 10; i++) {
+        int t;
+        t = a * i;
+        if(t > b) {
+            int u;
+            u = t - b;
+            return u;
+        }
+    }
+    return -1;
+}
+
+int g(int n)
+{
+    int s;
+    int k;
+    s = 0;
+    for(k = 0; k < n; k++) {
+        int w;
+        w = h(k, 4);
+        s = s * 2 + w;
+        if(s > 500) {
+            int z;
+            z = s + k;
+            return z;
+        }
+    }
+    return s;
+}
@@ -0,0 +1,6 @@
+int g(int n);
+
+int main()
+{
+    return !(g(6)+g(12)==659);
+}
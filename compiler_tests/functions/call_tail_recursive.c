@@ -0,0 +1,7 @@
+int f(int n, int acc)
+{
+    if(n <= 0) {
+        return acc;
+    }
+    return f(n - 1, acc + n % 7);
+}
@@ -0,0 +1,6 @@
+int f(int n, int acc);
+
+int main()
+{
+    return !(f(3000, 3)==9001);
+}
@@ -0,0 +1,24 @@
+int weigh(int a, int b, int c, int d, int e)
+{
+    return a + b*2 + c*3 + d*4 + e*5;
+}
+
+int f(int n)
+{
+    int total;
+    total = 0;
+    if(n <= 0) {
+        return 0;
+    }
+    {
+        int a = n;
+        int b = n + 1;
+        total = total + weigh(a, b, a, b, n);
+    }
+    {
+        int c = n * 2;
+        int d = c + 3;
+        total = total + weigh(d, c, d, c, total);
+    }
+    return total + f(n - 1);
+}
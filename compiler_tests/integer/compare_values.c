@@ -0,0 +1,21 @@
+int f(int a, int b, unsigned u)
+{
+    int r;
+    r = (a == b);
+    r = r * 2 + (a != b);
+    r = r * 2 + (a < b);
+    r = r * 2 + (a > b);
+    r = r * 2 + (a <= b);
+    r = r * 2 + (a >= b);
+    r = r * 2 + (a == 7);
+    r = r * 2 + (a != -3);
+    r = r * 2 + (b > 5);
+    r = r * 2 + (b <= -2);
+    r = r * 2 + (10 < a);
+    r = r * 2 + (u > 4);
+    r = r * 2 + (u < b);
+    r = r * 2 + (a == 70000);
+    r = r * 2 + !a;
+    r = r * 2 + !(a - b);
+    return r;
+}
@@ -0,0 +1,6 @@
+int f(int a, int b, unsigned u);
+
+int main()
+{
+    return !(f(7,-3,5)==22360 && f(70000,12,-1)==21940 && f(0,2,4)==26882);
+}
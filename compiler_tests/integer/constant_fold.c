@@ -0,0 +1,7 @@
+int f(int x)
+{
+    int a[4];
+    a[1+2] = (3*4+2) - (10/3) + (17%5) + (1<<4) + (256>>2) + ~5 + -(7);
+    a[0] = x*1 + (x-0) + (x|0) + x*0 + (x-x) + (x^x);
+    return a[3] + a[0] + sizeof(int);
+}
@@ -0,0 +1,6 @@
+int f(int x)
+{
+    int y = x;
+    y /= 7;
+    return x/3 + x/8 + x/(-10) + x%5 + x%16 + y*1000;
+}
@@ -0,0 +1,6 @@
+int f(int x)
+{
+    int y = x;
+    y *= 10;
+    return x*3 + x*7 + x*(-6) + 100*x + x*255 + x*1000 + y;
+}
@@ -0,0 +1,6 @@
+int f(int a, int b, int c)
+{
+    int d = a+1;
+    int e = b-2;
+    return ((a+b)*(c-d)+(e*(a-c)))*(((a^b)|(c&d))-((e<<2)>>1)) + ((a*b)-(c*d))*((e+a)-(b+c)) - (((a+1)*(b+2))*((c+3)*(d+4)))*(((e+5)*(a+6))-((b+7)*(c+8)));
+}
@@ -0,0 +1,6 @@
+int f(int a, int b, int c);
+
+int main()
+{
+    return !(f(-4,7,11)==-92578);
+}
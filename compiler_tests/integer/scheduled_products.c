@@ -0,0 +1,23 @@
+int products(int *a, int *b, int n)
+{
+    int x=a[0]*b[0];
+    int y=a[1]*b[1];
+    int z=a[2]+b[2];
+    int q=(x+y)/n;
+    int r=(x-y)%n;
+    a[0]=q*r;
+    return x+y*n+z+q+r+a[0]*b[2];
+}
+
+int f(int n)
+{
+    int a[3];
+    int b[3];
+    a[0]=3;
+    a[1]=-7;
+    a[2]=11;
+    b[0]=5;
+    b[1]=4;
+    b[2]=-2;
+    return products(a,b,n);
+}
@@ -0,0 +1,26 @@
+int f(int n)
+{
+    int a=1;
+    int b=2;
+    int c=3;
+    int d=4;
+    int e=5;
+    int g=6;
+    int h=7;
+    int i=8;
+    int j=9;
+    int k=10;
+    int l=11;
+    int m=12;
+    int s=0;
+    int *p;
+    p=&s;
+    while(n>0)
+    {
+        *p=*p+a+b+c+d+e+g+h+i+j+k+l+m;
+        a=a+1;
+        m=m-1;
+        n=n-1;
+    }
+    return s;
+}
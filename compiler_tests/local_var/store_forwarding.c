@@ -0,0 +1,25 @@
+int bump(int *p)
+{
+    *p = *p + 7;
+    return *p;
+}
+
+int f(int n)
+{
+    int a=n;
+    int b=3;
+    int c[4];
+    int i;
+    a+=n;
+    b*=a;
+    a-=b;
+    for(i=0;i<4;i++){
+        c[i]=a+i;
+    }
+    b+=c[2];
+    b+=bump(&a);
+    c[1]=b;
+    b+=a;
+    b+=c[1];
+    return a+b;
+}
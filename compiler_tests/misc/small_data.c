@@ -0,0 +1,42 @@
+int calls;
+int hits = 3;
+char flag;
+int pair[2];
+int table[16];
+float scale;
+double bias;
+
+int bump(int x)
+{
+    calls = calls + 1;
+    hits = hits + x;
+    return hits;
+}
+
+int f(int n)
+{
+    int i;
+    table[0] = n;
+    table[1] = n * 2;
+    table[2] = table[0] + table[1];
+    pair[0] = table[2];
+    pair[1] = pair[0] + 1;
+    flag = 7;
+    for(i = 0; i < n; i++) {
+        table[i + 3] = bump(i) + flag;
+    }
+    return calls + hits + pair[1] + table[n + 2] + table[2];
+}
+
+float g(float x)
+{
+    scale = scale + x;
+    return scale * x;
+}
+
+double h(double x)
+{
+    bias = bias + x;
+    bias = bias * x;
+    return bias;
+}
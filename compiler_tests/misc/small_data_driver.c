@@ -0,0 +1,8 @@
+int f(int n);
+float g(float x);
+double h(double x);
+
+int main()
+{
+    return !(f(5)==69 && g(2.0f)==4.0f && h(3.0)==9.0);
+}
@@ -0,0 +1,36 @@
+int g(int t)
+{
+    int x;
+    x=0;
+    switch(t)
+    {
+        case 10:
+            x=1;
+            break;
+        case 11:
+            x=2;
+        case 13:
+            x=x+3;
+            break;
+        case 14:
+            x=4;
+            break;
+        case 15:
+            x=5;
+            break;
+        default:
+            x=t;
+    }
+    return x;
+}
+
+int f(int n)
+{
+    int i;
+    int s;
+    s=0;
+    for(i=8;i<n;i++){
+        s=s*3+g(i);
+    }
+    return s+g(900);
+}
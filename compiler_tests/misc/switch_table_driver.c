@@ -0,0 +1,6 @@
+int f(int n);
+
+int main()
+{
+    return !(f(17)==76135);
+}
@@ -0,0 +1,19 @@
+int g;
+int arr[4];
+
+int f(int n)
+{
+    int x=n;
+    int *p=&x;
+    int s;
+    g=n*2;
+    arr[1]=g;
+    s=g+arr[1];
+    *p=s+1;
+    arr[2]=x;
+    arr[3]=s;
+    s=s+arr[2]+g+arr[3];
+    *p=*p+g;
+    arr[0]=x;
+    return s+x+arr[1];
+}
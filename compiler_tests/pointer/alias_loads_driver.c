@@ -0,0 +1,6 @@
+int f(int n);
+
+int main()
+{
+    return !(f(3)==68 && f(-5)==-108);
+}
@@ -6,10 +6,32 @@ int main(int argc, char** argv)
 
 
     std::ofstream myfile;
-    std::string out_file = argv[4];
-    myfile.open(out_file);
-    const Program *ast=parseAST(argv[2]);
+    char *in_file = nullptr;
+    std::string out_file = "";
     Context context;
+    for(int i=1;i<argc;i++) {                       // c_compiler [flags] -S <source> -o <assembly>
+        std::string flag = argv[i];
+        if(flag=="-S" && i+1<argc)  {
+            in_file = argv[++i];
+        }
+        else if(flag=="-o" && i+1<argc) {
+            out_file = argv[++i];
+        }
+        else if(flag.rfind("-finline-limit=",0)==0)  {   // largest function body (in instructions) expanded at a call site, 0 disables inlining
+            context.inlineLimit = std::stol(flag.substr(15));
+        }
+        else if(flag.rfind("-funroll-limit=",0)==0)  {   // largest unrolled for loop body (in instructions), 0 disables unrolling
+            context.unrollLimit = std::stol(flag.substr(15));
+        }
+        else if(flag=="-G" && i+1<argc) {                // largest global (in bytes) placed in small data, 0 disables $gp relative accesses
+            context.smallData = std::stol(argv[++i]);
+        }
+        else if(flag.rfind("-G",0)==0 && flag.size()>2)  {
+            context.smallData = std::stol(flag.substr(2));
+        }
+    }
+    myfile.open(out_file);
+    const Program *ast=parseAST(in_file);
 
     context.typeTable.insert(std::pair<std::string,typeInfo>("int",{"",4,0}));  // insert int type into typeTable
     context.typeTable.insert(std::pair<std::string,typeInfo>("char",{"",1,0}));  // insert char type into typeTable
@@ -30,11 +52,37 @@ int main(int argc, char** argv)
             myfile<<".ascii "<<'"'<<context.strList.at(i).second<<'"'<<std::endl;
         }
     }
-    myfile<<".data"<<std::endl;
+    for(int i=0;i<context.jumpTables.size();i++)    {     // switch jump tables
+        myfile<<".rdata"<<std::endl;
+        myfile<<".align 2"<<std::endl;
+        myfile<<context.jumpTables.at(i).first<<":"<<std::endl;
+        for(int j=0;j<context.jumpTables.at(i).second.size();j++)    {
+            myfile<<".word "<<context.jumpTables.at(i).second.at(j)<<std::endl;
+        }
+    }
+    myfile<<((context.smallData>=8) ? ".sdata" : ".data")<<std::endl;     // constants for ++/-- on FP values
     myfile<<"ONE_Double:    .double 1.0"<<std::endl;
+    myfile<<((context.smallData>=4) ? ".sdata" : ".data")<<std::endl;
     myfile<<"ONE_Float:     .float 1.0"<<std::endl;
     std::cout<<"done compiling"<<std::endl;
     myfile.close();
+
+    std::ifstream generated(out_file);     // post-pass: forward loads, drop unreachable code, schedule, fill branch delay slots
+    std::vector<std::string> lines;
+    std::string line;
+    while(std::getline(generated, line))    {
+        lines.push_back(line);
+    }
+    generated.close();
+    forwardMemory(lines);
+    removeDeadCode(lines);
+    scheduleBlocks(lines);
+    fillDelaySlots(lines);
+    myfile.open(out_file);
+    for(long i=0;i<lines.size();i++)    {
+        myfile<<lines.at(i)<<std::endl;
+    }
+    myfile.close();
     std::cout<<std::endl;
     
 
@@ -14,6 +14,8 @@
 #include "ast/ast_declarations.hpp"
 #include "ast/ast_statements.hpp"
 #include "ast/variable_table.hpp"
+#include "ast/register_allocator.hpp"
+#include "ast/magic_numbers.hpp"
 
 struct varType {
     int byteSize; //number of bytes for each element
@@ -29,6 +31,10 @@ union TokenValue{
 
 // extern TokenValue yylval;
 extern const Program *parseAST(char* file);
+extern void forwardMemory(std::vector<std::string> &lines);
+extern void removeDeadCode(std::vector<std::string> &lines);
+extern void scheduleBlocks(std::vector<std::string> &lines);
+extern void fillDelaySlots(std::vector<std::string> &lines);
 
 
 #endif
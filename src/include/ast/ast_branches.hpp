@@ -23,6 +23,20 @@ class Branch : public Program {
                 return 0;
             }
         }
+
+        virtual void regUsage(Context *context) const override  {
+            if(getAction()!=nullptr) {
+                getAction()->regUsage(context);
+            }
+        }
+
+        virtual int endsFlow(Context *context) const override  {
+            return (getAction()!=nullptr) ? getAction()->endsFlow(context) : 0;
+        }
+
+        virtual int straightLine() const override    {
+            return 0;
+        }
 };
 
 class IfBlock : public Branch {
@@ -52,8 +66,15 @@ class IfBlock : public Branch {
         }
 
         virtual long spaceRequired(Context *context) const override {
-            long tmp = getAction()->spaceRequired(context);
-            tmp+=getCondition()->spaceRequired(context);
+            long value;
+            int known = context->regs.knownCondition(this, value);
+            long tmp = getCondition()->spaceRequired(context);
+            if(known==0 || value!=0)    {
+                tmp+=getAction()->spaceRequired(context);
+            }
+            if(known==1 && value!=0)    {
+                return tmp;
+            }
             if(getElseIf()!=nullptr)    {
                 tmp+=getElseIf()->spaceRequired(context);
             }
@@ -63,6 +84,41 @@ class IfBlock : public Branch {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            long value;
+            getCondition()->regUsage(context);
+            if(getCondition()->getConstant(context, value)==1)   {  // only the branch taken is generated
+                context->regs.knownConds[this] = value;
+                if(value!=0)    {
+                    Branch::regUsage(context);
+                    return;
+                }
+            }
+            else    {
+                Branch::regUsage(context);
+            }
+            if(getElseIf()!=nullptr)    {
+                getElseIf()->regUsage(context);
+            }
+            if(getElse()!=nullptr)    {
+                getElse()->regUsage(context);
+            }
+        }
+
+        virtual int endsFlow(Context *context) const override  {   // every branch returns, breaks or continues
+            long value;
+            if(context->regs.knownCondition(this, value)==1 && value!=0)    {
+                return Branch::endsFlow(context);
+            }
+            if(context->regs.knownCondition(this, value)==0 && Branch::endsFlow(context)==0)    {
+                return 0;
+            }
+            if(getElseIf()!=nullptr && getElseIf()->endsFlow(context)==0)   {
+                return 0;
+            }
+            return (getElse()!=nullptr) ? getElse()->endsFlow(context) : 0;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"if( ";
             getCondition()->print(dst);
@@ -86,17 +142,25 @@ class IfBlock : public Branch {
             std::string initialEndPoint = context->BranchEndPoint;  // save previous BranchEndPoint (to support nested Ifs)
             context->BranchEndPoint = makeLabel("IF_end");
             std::string nextBranch = makeLabel("next");
-            getCondition()->generate(file, "$t6", context);     // process condition
-            file<<"beq $t6, $zero, "<<nextBranch<<std::endl;      // skip If action if condition evalutes to 0
-            file<<"nop"<<std::endl;
-            getAction()->generate(file, destReg, context);      // process action
-            file<<"b "<<context->BranchEndPoint<<std::endl;     // goto end of IfBlock
-            file<<"nop"<<std::endl;
-            file<<nextBranch<<":"<<std::endl;
-            if(getElseIf()!=nullptr)    {
+            long value;
+            int known = context->regs.knownCondition(this, value);
+            if(known==0)    {                                   // a folded condition only generates the branch it takes
+                getCondition()->generateBranch(file, nextBranch, 0, context);  // skip If action if condition evalutes to 0
+            }
+            if(known==0 || value!=0)    {
+                getAction()->generate(file, destReg, context);      // process action
+            }
+            if(known==0 && getAction()->endsFlow(context)==0 && (getElseIf()!=nullptr || getElse()!=nullptr))   {
+                file<<"b "<<context->BranchEndPoint<<std::endl;     // goto end of IfBlock
+                file<<"nop"<<std::endl;
+            }
+            if(known==0)    {
+                file<<nextBranch<<":"<<std::endl;
+            }
+            if(getElseIf()!=nullptr && (known==0 || value==0))  {
                 getElseIf()->generate(file, destReg, context);
             }
-            if(getElse()!=nullptr)  {
+            if(getElse()!=nullptr && (known==0 || value==0))    {
                 getElse()->generate(file, destReg, context);        // process Else action
             }                   
             file<<context->BranchEndPoint<<":"<<std::endl;
@@ -146,14 +210,42 @@ class ElseIfBlock : public Branch {
         }
 
         virtual long spaceRequired(Context *context) const override {
-            long tmp = getAction()->spaceRequired(context);
-            tmp+=getCondition()->spaceRequired(context);
-            if(getNext()!=nullptr)  {
+            long value;
+            int known = context->regs.knownCondition(this, value);
+            long tmp = getCondition()->spaceRequired(context);
+            if(known==0 || value!=0)    {
+                tmp+=getAction()->spaceRequired(context);
+            }
+            if(getNext()!=nullptr && (known==0 || value==0))  {
                 tmp+=getNext()->spaceRequired(context);
             }
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            long value;
+            getCondition()->regUsage(context);
+            int known = getCondition()->getConstant(context, value);
+            if(known==1)    {
+                context->regs.knownConds[this] = value;
+            }
+            if(known==0 || value!=0)    {
+                Branch::regUsage(context);
+            }
+            if(getNext()!=nullptr && (known==0 || value==0))  {
+                getNext()->regUsage(context);
+            }
+        }
+
+        virtual int endsFlow(Context *context) const override  {   // every action in the chain ends (the IfBlock checks the final else)
+            long value;
+            int known = context->regs.knownCondition(this, value);
+            if((known==0 || value!=0) && Branch::endsFlow(context)==0)  {
+                return 0;
+            }
+            return (getNext()!=nullptr && (known==0 || value==0)) ? getNext()->endsFlow(context) : 1;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"else if( ";
             getCondition()->print(dst);
@@ -170,14 +262,19 @@ class ElseIfBlock : public Branch {
         }
 
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            if(getAction()!=nullptr)    {
+            long value;
+            int known = context->regs.knownCondition(this, value);
+            if(getAction()!=nullptr && (known==0 || value!=0))    {
                 std::string nextLabel = makeLabel("next");
-                getCondition()->generate(file, "$t6", context);
-                file<<"beq $t6, $zero, "<<nextLabel<<std::endl;
-                file<<"nop"<<std::endl;
+                getCondition()->generateBranch(file, nextLabel, 0, context);
                 getAction()->generate(file, destReg, context);
-                file<<"b "<<context->BranchEndPoint<<std::endl;
-                file<<"nop"<<std::endl;
+                if(getAction()->endsFlow(context)==0)   {
+                    file<<"b "<<context->BranchEndPoint<<std::endl;
+                    file<<"nop"<<std::endl;
+                }
+                if(known==1)    {                               // later branches are unreachable
+                    return;
+                }
                 file<<nextLabel<<":"<<std::endl;
             }
             if(getNext()!=nullptr)  {
@@ -225,6 +322,17 @@ class CaseBlock : public Branch {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            getConstant()->regUsage(context);
+            Branch::regUsage(context);
+            if(getNextCase()!=nullptr)  {
+                getNextCase()->regUsage(context);
+            }
+            if(getDefaultAction()!=nullptr)  {
+                getDefaultAction()->regUsage(context);
+            }
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"case ";
             getConstant()->print(dst);
@@ -241,6 +349,21 @@ class CaseBlock : public Branch {
             }
         }
 
+        int caseValues(std::vector<long> &values, int &hasDefault, Context *context) const {  // collects the case constants in order, returns 0 if one is not a compile time constant
+            long value;
+            if(getConstant()->getConstant(context, value)==0)   {
+                return 0;
+            }
+            values.push_back(value);
+            if(getDefaultAction()!=nullptr) {
+                hasDefault = 1;
+            }
+            if(nextCase!=nullptr)   {
+                return nextCase->caseValues(values, hasDefault, context);
+            }
+            return 1;
+        }
+
         virtual void comparison(std::ofstream &file, const char* srcReg, Context *context) const override    {
             std::string nextLabel = makeLabel("nextcase");
             context->Case_label.push_back(nextLabel);
@@ -309,6 +432,105 @@ class SwitchBlock : public Branch {
             return casePtr;
         }
 
+    private:
+        void dispatch(std::ofstream &file, const std::vector<long> &values, int hasDefault, Context *context) const {   // jumps to the case labels, selector stays in a register
+            int isUnsigned = getExpr()->getUnsigned(context);
+            std::string sel = evalOperand(file, getExpr(), context);
+            std::vector<std::pair<long,std::string>> cases;     // case value (ordered as the selector compares) : label
+            for(long i=0;i<values.size();i++)   {
+                std::string label = makeLabel("case");
+                context->Case_label.push_back(label);
+                long key = (isUnsigned==1) ? (long)(unsigned int)values.at(i) : wrap(values.at(i));
+                int duplicate = 0;
+                for(long j=0;j<cases.size();j++)    {
+                    if(cases.at(j).first==key)  {
+                        duplicate = 1;
+                    }
+                }
+                if(duplicate==0)    {
+                    cases.push_back(std::pair<long,std::string>(key,label));
+                }
+            }
+            std::string defaultLabel = context->BranchEndPoint;
+            if(hasDefault==1)   {
+                defaultLabel = makeLabel("default");
+                context->Case_label.push_back(defaultLabel);
+            }
+            std::sort(cases.begin(), cases.end());
+            long range = cases.back().first - cases.front().first + 1;
+            if(cases.size()>=4 && range<=3*(long)cases.size())  {  // dense: bounds check and indexed jump
+                jumpTable(file, sel, cases, range, defaultLabel, context);
+            }
+            else    {                                           // sparse: balanced decision tree
+                searchTree(file, sel, cases, 0, cases.size()-1, defaultLabel, isUnsigned);
+            }
+        }
+
+        void jumpTable(std::ofstream &file, const std::string &sel, const std::vector<std::pair<long,std::string>> &cases, long range, const std::string &defaultLabel, Context *context) const {
+            long low = cases.front().first;
+            std::string index = sel;
+            if(low!=0)  {
+                if(-low>=-32768 && -low<=32767) {
+                    file<<"addiu $t0, "<<sel<<", "<<-low<<std::endl;
+                }
+                else    {
+                    file<<"li $t0, "<<wrap(low)<<std::endl;
+                    file<<"subu $t0, "<<sel<<", $t0"<<std::endl;
+                }
+                index = "$t0";
+            }
+            file<<"sltiu $t8, "<<index<<", "<<range<<std::endl;     // also catches selectors below the lowest case
+            file<<"beq $t8, $zero, "<<defaultLabel<<std::endl;
+            file<<"nop"<<std::endl;
+            std::string tableLabel = makeLabel("switch_table");
+            std::vector<std::string> entries(range, defaultLabel);
+            for(long i=0;i<cases.size();i++)    {
+                entries.at(cases.at(i).first-low) = cases.at(i).second;
+            }
+            context->jumpTables.push_back(std::pair<std::string,std::vector<std::string>>(tableLabel,entries));
+            file<<"sll $t0, "<<index<<", 2"<<std::endl;
+            file<<"lui $t8, %hi("<<tableLabel<<")"<<std::endl;
+            file<<"addu $t8, $t8, $t0"<<std::endl;
+            file<<"lw $t8, %lo("<<tableLabel<<")($t8)"<<std::endl;
+            file<<"jr $t8"<<std::endl;
+            file<<"nop"<<std::endl;
+        }
+
+        void searchTree(std::ofstream &file, const std::string &sel, const std::vector<std::pair<long,std::string>> &cases, long lo, long hi, const std::string &defaultLabel, int isUnsigned) const {
+            if(hi-lo<3) {                                       // up to three cases left: test each one
+                for(long i=lo;i<=hi;i++)    {
+                    if(cases.at(i).first==0)    {
+                        file<<"beq "<<sel<<", $zero, "<<cases.at(i).second<<std::endl;
+                    }
+                    else    {
+                        file<<"li $t0, "<<wrap(cases.at(i).first)<<std::endl;
+                        file<<"beq "<<sel<<", $t0, "<<cases.at(i).second<<std::endl;
+                    }
+                    file<<"nop"<<std::endl;
+                }
+                file<<"b "<<defaultLabel<<std::endl;
+                file<<"nop"<<std::endl;
+                return;
+            }
+            long mid = (lo+hi+1)/2;
+            long pivot = cases.at(mid).first;
+            std::string upperLabel = makeLabel("case_upper");
+            if(pivot>=(isUnsigned==1 ? 0 : -32768) && pivot<=32767)  {
+                file<<(isUnsigned==1 ? "sltiu" : "slti")<<" $t0, "<<sel<<", "<<pivot<<std::endl;
+            }
+            else    {
+                file<<"li $t0, "<<wrap(pivot)<<std::endl;
+                file<<(isUnsigned==1 ? "sltu" : "slt")<<" $t0, "<<sel<<", $t0"<<std::endl;
+            }
+            file<<"beq $t0, $zero, "<<upperLabel<<std::endl;    // selector >= pivot: upper half
+            file<<"nop"<<std::endl;
+            searchTree(file, sel, cases, lo, mid-1, defaultLabel, isUnsigned);
+            file<<upperLabel<<":"<<std::endl;
+            searchTree(file, sel, cases, mid, hi, defaultLabel, isUnsigned);
+        }
+
+    public:
+
         virtual long spaceRequired(Context *context) const override {
             long tmp = getExpr()->spaceRequired(context);
             if(getCasePtr()!=nullptr)    {
@@ -317,6 +539,15 @@ class SwitchBlock : public Branch {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            context->regs.pushScope();
+            getExpr()->regUsage(context);
+            if(getCasePtr()!=nullptr)    {
+                getCasePtr()->regUsage(context);
+            }
+            context->regs.popScope();
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"switch(";
             getExpr()->print(dst);
@@ -336,34 +567,32 @@ class SwitchBlock : public Branch {
             context->isLoop = 0;
             context->isSwitch = 1;
             std::unordered_map<std::string,varInfo> tmp;
-            long initStackSize = context->stack.size;
             long initSliderVal=context->stack.slider;
-            context->stack.slider=context->stack.size;
-            long delta=spaceRequired(context);
-            context->stack.size+=delta;
-            if(delta>0) {
-                file<<"addiu $sp, $sp, -"<<delta<<std::endl;
-            }
             context->stack.lut.push_back(tmp);
             std::list<std::string> initCase_Label = context->Case_label;
             std::list<std::string> case_label;
             context->Case_label = case_label;
             // std::string nextBranch = makeLabel("next");
-            getExpr()->generate(file,"$t7",context); // save expression that we need to compare
-            if(getCasePtr() != nullptr) {
+            std::vector<long> values;
+            int hasDefault = 0;
+            if(getCasePtr() != nullptr && casePtr->caseValues(values, hasDefault, context)==1) {
+                dispatch(file, values, hasDefault, context);
+                getCasePtr()->generate(file,destReg,context);
+            }
+            else if(getCasePtr() != nullptr) {                  // case labels that do not fold are compared one by one
+                getExpr()->generate(file,"$t7",context); // save expression that we need to compare
                 getCasePtr()->comparison(file,"$t7",context);
                 getCasePtr()->generate(file,destReg,context);
             }
+            else    {
+                getExpr()->generate(file,"$t7",context);
+            }
 
             file<<context->BranchEndPoint<<":"<<std::endl;
             context->BranchEndPoint = initialEndPoint;          // restore previous BranchEndPoint
             context->Case_label = initCase_Label;
             context->isSwitch = Switchinit;
             context->isLoop = Loopinit;
-            if(delta>0)    {
-                file<<"addiu $sp, $sp, "<<delta<<std::endl;    // shift down the stack pointer (always move sp by 4 to maintain word alignment)
-            }
-            context->stack.size=initStackSize;
             context->stack.slider=initSliderVal;
             context->stack.lut.pop_back();
         }
@@ -396,6 +625,12 @@ class TernaryBlock : public Branch {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            getCondition()->regUsage(context);
+            Branch::regUsage(context);
+            getFalse()->regUsage(context);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             getCondition()->print(dst);
             dst<<" ? ";
@@ -405,12 +640,31 @@ class TernaryBlock : public Branch {
             
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long condition;
+            if(getCondition()->getConstant(context, condition)==0)  {
+                return 0;
+            }
+            return (condition!=0) ? getAction()->getConstant(context, value) : getFalse()->getConstant(context, value);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            long condition;
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
+            if(getCondition()->getConstant(context, condition)==1)  {  // only the selected side is generated
+                if(condition!=0)    {
+                    getAction()->generate(file,destReg,context);
+                }
+                else    {
+                    getFalse()->generate(file,destReg,context);
+                }
+                return;
+            }
             std::string falseLabel = makeLabel("False_Expr");
             std::string ternaryLabel = makeLabel("Ternary_End");
-            getCondition()->generate(file,"$t7",context);
-            file<<"beq $t7, $zero, "<<falseLabel<<std::endl;
-            file<<"nop"<<std::endl;
+            getCondition()->generateBranch(file, falseLabel, 0, context);
             getAction()->generate(file,destReg,context);
             file<<"b "<<ternaryLabel<<std::endl;
             file<<"nop"<<std::endl;
@@ -33,6 +33,198 @@ class Condition : public Program {
             }
             return tmp;
         }
+
+        virtual void regUsage(Context *context) const override  {
+            if(getA()!=nullptr) {
+                getA()->regUsage(context);
+            }
+            if(getB()!=nullptr) {
+                getB()->regUsage(context);
+            }
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            std::string typeA = getA()->getVarType(context);
+            std::string typeB = getB()->getVarType(context);
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(typeA=="float" || typeA=="double" || typeB=="float" || typeB=="double")   {
+                return ExprRegStack::opaque;
+            }
+            return ExprRegStack::combine(getA()->regNeed(context), getB()->regNeed(context));
+        }
+
+    protected:
+        int constantOperands(Context *context, long &valueA, long &valueB) const {    // returns 1 if both sides fold to constants
+            if(getB()==nullptr) {
+                return 0;
+            }
+            if(getA()->getConstant(context, valueA)==0 || getB()->getConstant(context, valueB)==0)  {
+                return 0;
+            }
+            return 1;
+        }
+
+        void compareJump(std::ofstream &file, const std::string &label, int onTrue, std::string op, Context *context) const {   // jumps to label if (A op B) == onTrue, op is one of eq, ne, lt, gt, le, ge
+            if(branchConstant(file, label, onTrue, context)==1) {
+                return;
+            }
+            std::string typeA = getA()->getVarType(context);
+            std::string typeB = getB()->getVarType(context);
+            if(typeA=="float" || typeA=="double" || typeB=="float" || typeB=="double")   {
+                Program::generateBranch(file, label, onTrue, context);
+                return;
+            }
+            std::unordered_map<std::string,std::string> negated = {{"eq","ne"},{"ne","eq"},{"lt","ge"},{"ge","lt"},{"gt","le"},{"le","gt"}};
+            std::unordered_map<std::string,std::string> mirrored = {{"eq","eq"},{"ne","ne"},{"lt","gt"},{"gt","lt"},{"le","ge"},{"ge","le"}};
+            if(onTrue==0)   {
+                op = negated[op];
+            }
+            ProgramPtr left = getA();
+            ProgramPtr right = getB();
+            long value;
+            if(left->getConstant(context, value)==1)    {   // keep the constant on the right: c < x  ->  x > c
+                left = getB();
+                right = getA();
+                op = mirrored[op];
+            }
+            int isUnsigned = (left->getUnsigned(context)==1 || right->getUnsigned(context)==1) ? 1 : 0;
+            if(right->getConstant(context, value)==1 && op!="eq" && op!="ne")   {
+                if(value==0 && isUnsigned==0)   {           // bltz, bgtz, blez, bgez
+                    std::string reg = evalOperand(file, left, context);
+                    file<<"b"<<op<<"z "<<reg<<", "<<label<<std::endl;
+                    file<<"nop"<<std::endl;
+                    return;
+                }
+                long imm = (op=="gt" || op=="le") ? value+1 : value;    // x > c  ->  !(x < c+1)
+                if(imm>=(isUnsigned==1 ? 0 : -32768) && imm<=32767 && (isUnsigned==0 || value>=0))   {
+                    std::string reg = evalOperand(file, left, context);
+                    file<<(isUnsigned==1 ? "sltiu" : "slti")<<" $t0, "<<reg<<", "<<imm<<std::endl;
+                    file<<((op=="lt" || op=="le") ? "bne" : "beq")<<" $t0, $zero, "<<label<<std::endl;
+                    file<<"nop"<<std::endl;
+                    return;
+                }
+            }
+            std::string regA;
+            std::string regB;
+            evalOperands(file, left, right, regA, regB, context);
+            if(op=="eq" || op=="ne")    {
+                file<<"b"<<op<<" "<<regA<<", "<<regB<<", "<<label<<std::endl;
+            }
+            else    {
+                std::string slt = (isUnsigned==1) ? "sltu" : "slt";
+                if(op=="lt" || op=="ge")    {
+                    file<<slt<<" $t0, "<<regA<<", "<<regB<<std::endl;
+                }
+                else    {
+                    file<<slt<<" $t0, "<<regB<<", "<<regA<<std::endl;
+                }
+                file<<((op=="lt" || op=="gt") ? "bne" : "beq")<<" $t0, $zero, "<<label<<std::endl;
+            }
+            file<<"nop"<<std::endl;
+        }
+
+        int compareValue(std::ofstream &file, const char* destReg, std::string op, Context *context) const {   // destReg = (A op B) computed without branches, returns 0 for FP operands
+            if(generateConstant(file, destReg, context)==1) {
+                return 1;
+            }
+            std::string typeA = getA()->getVarType(context);
+            std::string typeB = getB()->getVarType(context);
+            if(typeA=="float" || typeA=="double" || typeB=="float" || typeB=="double")   {
+                return 0;
+            }
+            std::unordered_map<std::string,std::string> mirrored = {{"eq","eq"},{"ne","ne"},{"lt","gt"},{"gt","lt"},{"le","ge"},{"ge","le"}};
+            std::string dest = std::string(destReg);
+            ProgramPtr left = getA();
+            ProgramPtr right = getB();
+            long value;
+            if(left->getConstant(context, value)==1)    {   // keep the constant on the right: c < x  ->  x > c
+                left = getB();
+                right = getA();
+                op = mirrored[op];
+            }
+            int isUnsigned = (left->getUnsigned(context)==1 || right->getUnsigned(context)==1) ? 1 : 0;
+            std::string slt = (isUnsigned==1) ? "sltu" : "slt";
+            if(right->getConstant(context, value)==1)   {
+                if(op=="eq" || op=="ne")    {
+                    std::string reg = "";
+                    if(value==0)    {
+                        reg = evalOperand(file, left, context);
+                    }
+                    else if(value>0 && value<=65535)    {
+                        reg = evalOperand(file, left, context);
+                        file<<"xori "<<dest<<", "<<reg<<", "<<value<<std::endl;   // zero iff equal
+                        reg = dest;
+                    }
+                    else if(value<0 && value>=-32767)   {
+                        reg = evalOperand(file, left, context);
+                        file<<"addiu "<<dest<<", "<<reg<<", "<<-value<<std::endl;
+                        reg = dest;
+                    }
+                    if(reg!="") {
+                        if(op=="eq")    {
+                            file<<"sltiu "<<dest<<", "<<reg<<", 1"<<std::endl;
+                        }
+                        else    {
+                            file<<"sltu "<<dest<<", $zero, "<<reg<<std::endl;
+                        }
+                        return 1;
+                    }
+                }
+                else    {
+                    long imm = (op=="gt" || op=="le") ? value+1 : value;    // x > c  ->  !(x < c+1)
+                    if(imm>=(isUnsigned==1 ? 0 : -32768) && imm<=32767 && (isUnsigned==0 || value>=0))   {
+                        std::string reg = evalOperand(file, left, context);
+                        file<<(isUnsigned==1 ? "sltiu" : "slti")<<" "<<dest<<", "<<reg<<", "<<imm<<std::endl;
+                        if(op=="gt" || op=="ge")    {
+                            file<<"xori "<<dest<<", "<<dest<<", 1"<<std::endl;
+                        }
+                        return 1;
+                    }
+                }
+            }
+            std::string regA;
+            std::string regB;
+            evalOperands(file, left, right, regA, regB, context);
+            if(op=="eq" || op=="ne")    {
+                file<<"xor "<<dest<<", "<<regA<<", "<<regB<<std::endl;
+                if(op=="eq")    {
+                    file<<"sltiu "<<dest<<", "<<dest<<", 1"<<std::endl;
+                }
+                else    {
+                    file<<"sltu "<<dest<<", $zero, "<<dest<<std::endl;
+                }
+                return 1;
+            }
+            if(op=="lt" || op=="ge")    {                   // a >= b  ->  !(a < b)
+                file<<slt<<" "<<dest<<", "<<regA<<", "<<regB<<std::endl;
+            }
+            else    {                                       // a > b  ->  b < a,  a <= b  ->  !(b < a)
+                file<<slt<<" "<<dest<<", "<<regB<<", "<<regA<<std::endl;
+            }
+            if(op=="ge" || op=="le")    {
+                file<<"xori "<<dest<<", "<<dest<<", 1"<<std::endl;
+            }
+            return 1;
+        }
+
+        void compareBranch(std::ofstream &file, const char* destReg, const char* branch, const char* label, Context *context) const {  // destReg = 1 if branch on A, B is taken
+            std::string regA;
+            std::string regB;
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
+            evalOperands(file, getA(), getB(), regA, regB, context);
+            file<<"addiu $t0, $zero, 1"<<std::endl;         // set result = 1
+            std::string tmpLabel=makeLabel(label);
+            file<<branch<<" "<<regA<<", "<<regB<<", "<<tmpLabel<<std::endl;     // if condition holds, skip zeroing of result
+            file<<"nop"<<std::endl;
+            file<<"addiu $t0, $zero, 0"<<std::endl;         // zero result
+            file<<tmpLabel<<":"<<std::endl;
+            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+        }
 };
 
 class EqualTo : public Condition {      // a == b
@@ -45,6 +237,19 @@ class EqualTo : public Condition {      // a == b
             getB()->print(dst);
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA == valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "eq", context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
             long tmpOffset = context->stack.size - context->stack.slider;
             std::string type = getA()->getVarType(context);
@@ -74,19 +279,7 @@ class EqualTo : public Condition {      // a == b
                 file<<tmpLabel<<":"<<std::endl;
                 file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
             } else {
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;      // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_EQ");
-            file<<"beq $t1, $t2, "<<tmpLabel<<std::endl;                        // beq $t1, $t2, tmpLabel (if A == B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+                compareValue(file, destReg, "eq", context);
             }
         }
 };
@@ -101,21 +294,23 @@ class NotEqual : public Condition {     // a != b
             getB()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            long tmpOffset = context->stack.size - context->stack.slider;
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;       // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_NEQ");
-            file<<"bne $t1, $t2, "<<tmpLabel<<std::endl;                        // bne $t1, $t2, tmpLabel (if A != B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA != valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "ne", context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
+            if(compareValue(file, destReg, "ne", context)==0)  {
+                compareBranch(file, destReg, "bne", "cond_NEQ", context);
+            }
         }
 };
 
@@ -129,21 +324,23 @@ class GreaterThan : public Condition {  // a > b
             getB()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
-            long tmpOffset = context->stack.size - context->stack.slider;
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;       // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_GR");
-            file<<"bgt $t1, $t2, "<<tmpLabel<<std::endl;                        // bgt $t1, $t2, tmpLabel (if A != B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA > valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "gt", context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
+            if(compareValue(file, destReg, "gt", context)==0)  {
+                compareBranch(file, destReg, "bgt", "cond_GR", context);
+            }
         }
 };
 
@@ -157,21 +354,23 @@ class GreaterEqual : public Condition { // a >= b
             getB()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
-            long tmpOffset = context->stack.size - context->stack.slider;
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;      // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_GE");
-            file<<"bge $t1, $t2, "<<tmpLabel<<std::endl;                        // bge $t1, $t2, tmpLabel (if A != B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<< std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA >= valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "ge", context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
+            if(compareValue(file, destReg, "ge", context)==0)  {
+                compareBranch(file, destReg, "bge", "cond_GE", context);
+            }
         }
 };
 
@@ -179,27 +378,38 @@ class LessThan : public Condition {     // a < b
     public:
         LessThan(ProgramPtr _a, ProgramPtr _b) : Condition(_a,_b)   {}
 
+        virtual int countedBound(ProgramPtr &counter, ProgramPtr &bound) const override    {
+            if(getA()->variableID()=="")    {
+                return 0;
+            }
+            counter = getA();
+            bound = getB();
+            return 1;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             getA()->print(dst);
             dst<<" < ";
             getB()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            long tmpOffset = context->stack.size - context->stack.slider;
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;      // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_LT");
-            file<<"blt $t1, $t2, "<<tmpLabel<<std::endl;                        // blt $t1, $t2, tmpLabel (if A != B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA < valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "lt", context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
+            if(compareValue(file, destReg, "lt", context)==0)  {
+                compareBranch(file, destReg, "blt", "cond_LT", context);
+            }
         }
 };
 
@@ -207,27 +417,38 @@ class LessEqual : public Condition {    // a <= b
     public:
         LessEqual(ProgramPtr _a, ProgramPtr _b) : Condition(_a,_b)   {}
 
+        virtual int countedBound(ProgramPtr &counter, ProgramPtr &bound) const override    {
+            if(getA()->variableID()=="")    {
+                return 0;
+            }
+            counter = getA();
+            bound = getB();
+            return 2;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             getA()->print(dst);
             dst<<" <= ";
             getB()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            long tmpOffset = context->stack.size - context->stack.slider;
-            getA()->generate(file, "$t1", context);                             // store value of A into $t1
-            file<<"sw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getB()->generate(file, "$t2", context);                             // store value of B into $t2
-            file<<"lw $t1, "<<tmpOffset<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"addiu $t0, $zero, 1"<<std::endl;      // addiu destReg, $zero, 1 (set destReg = 1)
-            std::string tmpLabel=makeLabel("cond_LE");
-            file<<"ble $t1, $t2, "<<tmpLabel<<std::endl;                        // ble $t1, $t2, tmpLabel (if A != B, skip zeroing of destReg)
-            file<<"nop"<<std::endl;
-            file<<"addiu $t0, $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<tmpLabel<<":"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(constantOperands(context, valueA, valueB)==0)    {
+                return 0;
+            }
+            value = (valueA <= valueB) ? 1 : 0;
+            return 1;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            compareJump(file, label, onTrue, "le", context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {   // destReg = 1 if true, destReg = 0 if false
+            if(compareValue(file, destReg, "le", context)==0)  {
+                compareBranch(file, destReg, "ble", "cond_LE", context);
+            }
         }
 };
 
@@ -241,16 +462,77 @@ class LogicalAND : public Condition {
             getB()->print(dst);
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(getA()->getConstant(context, valueA)==1) {
+                if(valueA==0)   {           // 0 && x
+                    value = 0;
+                    return 1;
+                }
+                if(getB()->getConstant(context, valueB)==1) {
+                    value = (valueB!=0) ? 1 : 0;
+                    return 1;
+                }
+                return 0;
+            }
+            if(getB()->getConstant(context, valueB)==1 && valueB==0 && isPure(getA(), context)==1)  {    // x && 0
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {     // A is dead once B is evaluated
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            return ExprRegStack::combine(std::max(getA()->regNeed(context), getB()->regNeed(context)), 0);
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            if(branchConstant(file, label, onTrue, context)==1) {
+                return;
+            }
+            if(onTrue==0)   {                               // either side false: jump
+                getA()->generateBranch(file, label, 0, context);
+                getB()->generateBranch(file, label, 0, context);
+                return;
+            }
+            std::string falsePoint = makeLabel("cond_false");
+            getA()->generateBranch(file, falsePoint, 0, context);   // A false: fall through past the jump
+            getB()->generateBranch(file, label, 1, context);
+            file<<falsePoint<<":"<<std::endl;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            long value;
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
+            ProgramPtr operand = nullptr;       // a true constant side drops out
+            if(getA()->getConstant(context, value)==1)  {
+                operand = getB();
+            }
+            else if(getB()->getConstant(context, value)==1 && value!=0) {
+                operand = getA();
+            }
+            if(operand!=nullptr)    {
+                std::string reg = evalOperand(file, operand, context);
+                file<<"sltu "<<std::string(destReg)<<", $zero, "<<reg<<std::endl;
+                return;
+            }
+            std::string falsePoint=makeLabel("cond_false");
             std::string endPoint=makeLabel("cond_end");
-            file<<"addiu "<<std::string(destReg)<<", $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            getA()->generate(file, "$t1", context);                             // evaluate A
-            file<<"beq $t1, $zero, "<<endPoint<<std::endl;                      // if A == 0, jump to end (final destReg value is 0)
+            std::string regA = evalOperand(file, getA(), context);             // evaluate A
+            file<<"beq "<<regA<<", $zero, "<<falsePoint<<std::endl;            // if A == 0, result is 0
             file<<"nop"<<std::endl;
-            getB()->generate(file, "$t2", context);                             // evaluate B
-            file<<"beq $t2, $zero, "<<endPoint<<std::endl;                      // if B == 0, jump to end (final destReg value is 0)
+            std::string regB = evalOperand(file, getB(), context);             // evaluate B
+            file<<"sltu "<<std::string(destReg)<<", $zero, "<<regB<<std::endl;  // result is 1 if B != 0
+            file<<"b "<<endPoint<<std::endl;
             file<<"nop"<<std::endl;
-            file<<"addiu "<<std::string(destReg)<<", $zero, 1"<<std::endl;      // addiu destReg, $zer0, 1 (set destReg to 1 if A and B are non-zero)
+            file<<falsePoint<<":"<<std::endl;
+            file<<"move "<<std::string(destReg)<<", $zero"<<std::endl;
             file<<endPoint<<":"<<std::endl;
         }
 };
@@ -265,16 +547,77 @@ class LogicalOR : public Condition {
             getB()->print(dst);
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA, valueB;
+            if(getA()->getConstant(context, valueA)==1) {
+                if(valueA!=0)   {           // 1 || x
+                    value = 1;
+                    return 1;
+                }
+                if(getB()->getConstant(context, valueB)==1) {
+                    value = (valueB!=0) ? 1 : 0;
+                    return 1;
+                }
+                return 0;
+            }
+            if(getB()->getConstant(context, valueB)==1 && valueB!=0 && isPure(getA(), context)==1)  {    // x || 1
+                value = 1;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {     // A is dead once B is evaluated
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            return ExprRegStack::combine(std::max(getA()->regNeed(context), getB()->regNeed(context)), 0);
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            if(branchConstant(file, label, onTrue, context)==1) {
+                return;
+            }
+            if(onTrue==1)   {                               // either side true: jump
+                getA()->generateBranch(file, label, 1, context);
+                getB()->generateBranch(file, label, 1, context);
+                return;
+            }
+            std::string truePoint = makeLabel("cond_true");
+            getA()->generateBranch(file, truePoint, 1, context);    // A true: fall through past the jump
+            getB()->generateBranch(file, label, 0, context);
+            file<<truePoint<<":"<<std::endl;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            long value;
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
+            ProgramPtr operand = nullptr;       // a false constant side drops out
+            if(getA()->getConstant(context, value)==1)  {
+                operand = getB();
+            }
+            else if(getB()->getConstant(context, value)==1 && value==0) {
+                operand = getA();
+            }
+            if(operand!=nullptr)    {
+                std::string reg = evalOperand(file, operand, context);
+                file<<"sltu "<<std::string(destReg)<<", $zero, "<<reg<<std::endl;
+                return;
+            }
+            std::string truePoint = makeLabel("cond_true");
             std::string endPoint = makeLabel("cond_end");
-            file<<"addiu "<<std::string(destReg)<<", $zero, 1"<<std::endl;      // addiu destReg, $zer0, 1 (set destReg to 1) 
-            getA()->generate(file, "$t1", context);                             // evaluate A
-            file<<"bne $t1, $zero, "<<endPoint<<std::endl;                        // if A != 0, jump to end (final destreg value is 1)
+            std::string regA = evalOperand(file, getA(), context);             // evaluate A
+            file<<"bne "<<regA<<", $zero, "<<truePoint<<std::endl;             // if A != 0, result is 1
             file<<"nop"<<std::endl;
-            getB()->generate(file, "$t2", context);                             // evalute B
-            file<<"bne $t2, $zero, "<<endPoint<<std::endl;                        // if B != 0, jump to end (final destreg value is 1)
+            std::string regB = evalOperand(file, getB(), context);             // evalute B
+            file<<"sltu "<<std::string(destReg)<<", $zero, "<<regB<<std::endl;  // result is 1 if B != 0
+            file<<"b "<<endPoint<<std::endl;
             file<<"nop"<<std::endl;
-            file<<"addiu "<<std::string(destReg)<<", $zero, 0"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
+            file<<truePoint<<":"<<std::endl;
+            file<<"addiu "<<std::string(destReg)<<", $zero, 1"<<std::endl;
             file<<endPoint<<":"<<std::endl;
         }
 };
@@ -288,16 +631,37 @@ class LogicalNOT : public Condition {
             getA()->print(dst);
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            std::string endPoint = makeLabel("cond_not");
-            file<<"addiu "<<std::string(destReg)<<", $zero, 0"<<std::endl;      // addiu destReg, $zer0, 1 (set destReg to 1) 
-            getA()->generate(file, "$t1", context); 
-            file<<"bne $t1, $zero, "<<endPoint<<std::endl;                        // if A != 0, jump to end (final destreg value is 1)
-            file<<"nop"<<std::endl;
-            file<<"addiu "<<std::string(destReg)<<", $zero, 1"<<std::endl;      // addiu destReg, $zero, 0 (zero destReg) 
-            file<<endPoint<<":"<<std::endl;
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueA;
+            if(getA()->getConstant(context, valueA)==0) {
+                return 0;
+            }
+            value = (valueA==0) ? 1 : 0;
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            return ExprRegStack::combine(getA()->regNeed(context), 0);
+        }
 
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const override  {
+            if(branchConstant(file, label, onTrue, context)==1) {
+                return;
+            }
+            getA()->generateBranch(file, label, 1-onTrue, context);
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
+            std::string regA = evalOperand(file, getA(), context);
+            file<<"sltiu "<<std::string(destReg)<<", "<<regA<<", 1"<<std::endl;  // 1 only if A == 0
         }
 };
 
-#endif
\ No newline at end of file
+#endif
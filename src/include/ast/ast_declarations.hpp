@@ -66,7 +66,10 @@ class DeclareVariable : public Program {
             if(tmp%4)   {
                 tmp+=4-(tmp%4);
             }
-            if(init!=nullptr)   {
+            if(context->regs.regFor(this)!="" || context->regs.isUnread(this)==1)  {   // variable lives in a register or is never read, no stack slot needed
+                tmp=0;
+            }
+            if(init!=nullptr && !(context->regs.isUnread(this)==1 && pureInit(context)==1))   {
                 tmp += init->spaceRequired(context);
             }
             if(context->structTable.find(t)!=context->structTable.end() && ptr==0)    {   // struct instance needs 4 more bytes for base pointer
@@ -75,6 +78,70 @@ class DeclareVariable : public Program {
             return tmp;
         }
 
+        virtual ProgramPtr assignedValue(const std::string &_id) const override {
+            return (_id==id && ptr==0) ? init : nullptr;
+        }
+
+        int pureInit(Context *context) const {    // initializer has no side effects (can be dropped with the variable)
+            long value;
+            return (init==nullptr || init->hoistable()==1 || init->getConstant(context, value)==1) ? 1 : 0;
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            if(init!=nullptr)   {
+                init->regUsage(context);
+            }
+            int eligible=1;         // only plain 4 byte integers and pointers are kept in registers
+            int removable=1;        // integers, chars and pointers can be dropped if never read
+            int isPtr=ptr;
+            long numBytes=1;
+            int isFP=0;
+            int uns=isUnsigned;
+            std::string t=type;
+            std::unordered_map<std::string,typeInfo>::iterator typeIT;
+            std::string bindType = type;
+            while(bindType!="") {
+                typeIT = context->typeTable.find(bindType);
+                if(typeIT==context->typeTable.end())    {   // type not known yet (local typedef)
+                    eligible=0;
+                    removable=0;
+                    break;
+                }
+                bindType = typeIT->second.type;
+                numBytes*=typeIT->second.size;
+                if(typeIT->second.type!="") {
+                    t=typeIT->second.type;
+                }
+                if(typeIT->second.ptr > isPtr)  {
+                    isPtr = typeIT->second.ptr;
+                }
+                if(typeIT->second.isFP > isFP)  {
+                    isFP = typeIT->second.isFP;
+                }
+                if(typeIT->second.isUnsigned > uns)  {
+                    uns = typeIT->second.isUnsigned;
+                }
+            }
+            if(isFP==1 || (context->structTable.find(t)!=context->structTable.end() && isPtr==0))   {
+                eligible=0;
+                removable=0;
+            }
+            if(context->structTable.find(t)!=context->structTable.end() && isPtr==0)    {
+                context->regs.frameEscapes=1;
+            }
+            if(numBytes!=4 && isPtr==0) {
+                eligible=0;
+            }
+            context->regs.declare(id, this, eligible);
+            if(removable==1)    {
+                context->regs.drop(this);
+            }
+            long value;
+            if(eligible==1 && isPtr==0 && uns==0 && t!="unsigned" && init!=nullptr && init->getConstant(context, value)==1)  {
+                context->regs.constantInit(this, value);
+            }
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
             long size = context->stack.lut.size();
             long offset = context->stack.slider;
@@ -131,8 +198,42 @@ class DeclareVariable : public Program {
             if(vf.isPtr==1) {   // set size to be 4 bytes if it is a pointer
                 vf.numBytes=4;
             }
+            vf.reg = context->regs.regFor(this);
+            std::unordered_map<const void*,long>::iterator constIT = context->regs.constants.find(this);
+            if(size!=1 && constIT!=context->regs.constants.end())  {  // reads fold to the initializer
+                vf.isConst = 1;
+                vf.initValue = constIT->second;
+            }
+            if(size!=1 && context->regs.isUnread(this)==1)  {  // never read: no storage, the initializer only runs for its side effects
+                if(init!=nullptr && pureInit(context)==0)    {
+                    init->generate(file, "$t7", context);
+                    context->strLiteralLength=0;
+                    context->isStrLiteral=0;
+                }
+                vf.dead=1;
+                context->stack.lut.back().insert(std::pair<std::string,varInfo>(getID(),vf));
+                return;
+            }
+            if(vf.reg!="" && size!=1)   {   // local variable held in a register
+                if(init!=nullptr)   {
+                    init->generate(file, "$t7", context);
+                    file<<"move "<<vf.reg<<", $t7"<<std::endl;
+                    if(vf.isPtr==1 && context->isStrLiteral==1) {
+                        vf.dimension.push_back(context->strLiteralLength);
+                        vf.blockSize.push_back(1);
+                        context->strLiteralLength=0;
+                        context->isStrLiteral=0;
+                    }
+                }
+                context->stack.lut.back().insert(std::pair<std::string,varInfo>(getID(),vf));
+                if (std::string(destReg)!="$f0"){
+                    file<<"li "<<std::string(destReg)<<", 1"<<std::endl;
+                }
+                return;
+            }
             if (size == 1) {
                 vf.isGlobal = 1;
+                vf.isSmall = isSmallData(vf.numBytes, context);
                 if (init!= nullptr){
                     if (vf.isFP == 1){
                         init->generate(file,"$f10",context);
@@ -140,7 +241,7 @@ class DeclareVariable : public Program {
                         init->generate(file, "$t7", context);
                     }
                     std::string value = context->numVal;
-                    file<<"   .data"<<std::endl;
+                    file<<"   "<<((vf.isSmall==1) ? ".sdata" : ".data")<<std::endl;
                     file<<"   .globl  "<<getID()<<std::endl;
                     file<<"   .type   "<<getID()<<", @object"<<std::endl;
                     file<<"   .size   "<<getID()<<", "<<vf.numBytes<<std::endl;
@@ -158,7 +259,7 @@ class DeclareVariable : public Program {
                 } else if (init == nullptr){
                     file<<"   .globl  "<<getID()<<std::endl;
                     file<<"   .type   "<<getID()<<", @object"<<std::endl;
-                    file<<"   .section        .bss,\"aw\",@nobits"<<std::endl;
+                    file<<"   .section        "<<((vf.isSmall==1) ? ".sbss" : ".bss")<<",\"aw\",@nobits"<<std::endl;
                     file<<"   .size   "<<getID()<<", "<<vf.numBytes<<std::endl;
                     file<<getID()<<":"<<std::endl;
                     file<<"   .space   "<<vf.numBytes<<std::endl;
@@ -291,6 +392,11 @@ class DeclareArray : public Program {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {   // elements live on the stack, the base pointer may be kept in a register
+            context->regs.declare(id, this, 1);
+            context->regs.frameEscapes=1;       // the name decays to a pointer into the frame
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<type<<" "<<id;
             dimensions->print(dst);
@@ -330,9 +436,10 @@ class DeclareArray : public Program {
             }
             if(context->stack.lut.size()==1)    {   // global array
                 vf.isGlobal = 1;
+                vf.isSmall = isSmallData(vf.numBytes*vf.length, context);
                 if (init!=nullptr){
                     file<<"   .globl  "<<getID()<<std::endl;
-                    file<<"   .data"<<std::endl;
+                    file<<"   "<<((vf.isSmall==1) ? ".sdata" : ".data")<<std::endl;
                     file<<"   .type   "<<getID()<<", @object"<<std::endl;
                     file<<"   .size     "<<getID()<<",  "<<vf.numBytes*vf.length<<std::endl;
                     file<<getID()<<":"<<std::endl;
@@ -343,7 +450,7 @@ class DeclareArray : public Program {
                 } else if (init ==nullptr){
                     file<<"   .globl  "<<getID()<<std::endl;
                     file<<"   .type   "<<getID()<<", @object"<<std::endl;
-                    file<<"   .section        .bss,\"aw\",@nobits"<<std::endl;
+                    file<<"   .section        "<<((vf.isSmall==1) ? ".sbss" : ".bss")<<",\"aw\",@nobits"<<std::endl;
                     file<<"   .size     "<<getID()<<",  "<<vf.numBytes*vf.length<<std::endl;
                     file<<getID()<<":"<<std::endl;
                     file<<"   .space    "<<vf.numBytes*vf.length<<std::endl;
@@ -358,6 +465,10 @@ class DeclareArray : public Program {
                 vf.offset=context->stack.slider-4;    // offset of base pointer
                 file<<"addiu $t1, $sp, "<<(context->stack.size - vf.offset+4)<<std::endl;   // store 1st element address into base pointer
                 file<<"sw $t1, "<<(context->stack.size - vf.offset)<<"($sp)"<<std::endl;
+                vf.reg = context->regs.regFor(this);
+                if(vf.reg!="")  {                   // accesses in loops no longer reload the base pointer
+                    file<<"move "<<vf.reg<<", $t1"<<std::endl;
+                }
                 if(init!=nullptr)   {   // initilise array values if required ($t1 contains address of first index)
                     long initIC = context->indexCounter;
                     context->indexCounter=0;
@@ -483,33 +594,47 @@ class FunctionSizeof : public Program {
             dst<<")";
         }
 
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+        virtual int getConstant(Context *context, long &value) const override  {
             std::unordered_map<std::string,varInfo>::iterator it;   // sizeof variable
             int n=context->stack.lut.size()-1;
             for(int i=n;i>=0;i--)   {
                 it=context->stack.lut.at(i).find(id);
                 if(it!=context->stack.lut.at(i).end()) {
-                    long byteSize = it->second.numBytes * it->second.length;
-                    file<<"li "<<destReg<<", "<<byteSize<<std::endl;
-                    return;
+                    value = it->second.numBytes * it->second.length;
+                    return 1;
                 }
             }
             std::unordered_map<std::string,typeInfo>::iterator typeIT;  // sizeof type
             std::string bind_name=id;
-            std::string type=id;
             long byteSize=1;
             while(bind_name!="")    {
                 typeIT=context->typeTable.find(bind_name);
-                bind_name=typeIT->second.type;
-                if(typeIT->second.type!="") {
-                    type=typeIT->second.type;
+                if(typeIT==context->typeTable.end())    {
+                    return 0;
                 }
+                bind_name=typeIT->second.type;
                 byteSize*=typeIT->second.size;
             }
             if(elements!=nullptr)   {
                 byteSize*=elements->spaceRequired(context);    // get number of elements for type arrays ie int[10]
-            }            
-            file<<"li "<<destReg<<", "<<byteSize<<std::endl;
+            }
+            value = byteSize;
+            return 1;
+        }
+
+        virtual int hoistable() const override  {
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            int need = constantNeed(context);
+            return (need>=0) ? need : ExprRegStack::opaque;
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateConstant(file, destReg, context)==0) {
+                throw std::runtime_error("sizeof of unknown type "+id);
+            }
         }
 };
 
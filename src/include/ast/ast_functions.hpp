@@ -16,6 +16,14 @@ class FunctionArgs : public Program {
             delete next;
         }
 
+        ProgramPtr getAction() const    {
+            return action;
+        }
+
+        const FunctionArgs *getNext() const    {
+            return next;
+        }
+
         virtual long getCount() const   {
             if(next!=nullptr)   {
                 return 1+next->getCount();
@@ -31,6 +39,17 @@ class FunctionArgs : public Program {
                 next->print(dst);
             }
         }
+
+        int hasFPArgs(Context *context) const   {
+            std::string type = action->getVarType(context);
+            if(type=="float" || type=="double") {
+                return 1;
+            }
+            if(next!=nullptr)   {
+                return next->hasFPArgs(context);
+            }
+            return 0;
+        }
 };
 
 class FunctionDefArgs : public FunctionArgs {
@@ -69,6 +88,74 @@ class FunctionDefArgs : public FunctionArgs {
             }
         }
 
+        virtual void regUsage(Context *context) const override  {
+            long index = context->regs.intervals.size();    // arguments are declared before anything else
+            if((type=="float"||type=="double") && ptr==0)    {
+                context->regs.fpArgs=1;
+                context->regs.declare(id, this, 0);
+            }
+            else    {
+                std::string hint="";
+                if(context->regs.fpArgs==0 && index<4)  {   // argument arrives in $a<index>
+                    hint = "$a"+std::to_string(index);
+                }
+                context->regs.declare(id, this, (ptr==1 || type=="int"), hint);
+            }
+            if(next!=nullptr)   {
+                next->regUsage(context);
+            }
+        }
+
+        int inlineable() const  {           // an inlined call can bind word sized integer and pointer parameters
+            if(ptr==0 && type!="int" && type!="unsigned")   {
+                return 0;
+            }
+            if(next!=nullptr)   {
+                return static_cast<const FunctionDefArgs*>(next)->inlineable();
+            }
+            return 1;
+        }
+
+        void inlineUsage(long start, Context *context) const    {  // parameters of an inlined call are written while its arguments are evaluated
+            context->regs.declare(id, this, (ptr==1 || type=="int"));
+            context->regs.liveFrom(id, start);
+            if(next!=nullptr)   {
+                static_cast<const FunctionDefArgs*>(next)->inlineUsage(start, context);
+            }
+        }
+
+        long inlineSlots(Context *context) const    {   // parameters of an inlined call that live on the stack
+            long tmp = (context->regs.regFor(this)=="") ? 1 : 0;
+            if(next!=nullptr)   {
+                tmp+=static_cast<const FunctionDefArgs*>(next)->inlineSlots(context);
+            }
+            return tmp;
+        }
+
+        void generateInline(std::ofstream &file, const FunctionArgs *value, long &slot, std::unordered_map<std::string,varInfo> &params, Context *context) const  {
+            varInfo vf;                                 // evaluate the argument straight into the parameter's register or stack slot
+            vf.length=1;
+            vf.type=type;
+            vf.isPtr=ptr;
+            vf.numBytes=4;
+            vf.reg = context->regs.regFor(this);
+            std::string reg = evalOperand(file, value->getAction(), context);
+            if(vf.reg!="")  {
+                if(reg!=vf.reg) {
+                    file<<"move "<<vf.reg<<", "<<reg<<std::endl;
+                }
+            }
+            else    {
+                vf.offset = slot;
+                slot+=4;
+                file<<"sw "<<reg<<", "<<(context->stack.size - vf.offset)<<"($sp)"<<std::endl;
+            }
+            params[id]=vf;                              // bound after all arguments are evaluated (they see the caller's names)
+            if(next!=nullptr)   {
+                static_cast<const FunctionDefArgs*>(next)->generateInline(file, value->getNext(), slot, params, context);
+            }
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             varInfo vf;
             vf.length=1;
@@ -118,9 +205,25 @@ class FunctionDefArgs : public FunctionArgs {
                 else    {
                     vf.numBytes=4;
                 }
+                vf.reg = context->regs.regFor(this);
                 context->stack.lut.back().insert(std::pair<std::string,varInfo>(id,vf));
                 context->ftEntry->second.argList.push_back(vf);
-                if(context->FPArgCount>0 && context->ArgOffset<12){
+                if(vf.reg!="")  {                       // argument is kept in a register
+                    std::string srcReg="";
+                    if(context->FPArgCount>0 && context->ArgOffset<12)  {
+                        srcReg = "$a"+std::to_string(context->totalArgCount);
+                    }
+                    else if(context->ArgCount<4)    {
+                        srcReg = "$a"+std::to_string(context->ArgCount);
+                    }
+                    if(srcReg=="")  {
+                        file<<"lw "<<vf.reg<<", "<<(context->stack.size - delta)<<"($sp)"<<std::endl;
+                    }
+                    else if(srcReg!=vf.reg) {
+                        file<<"move "<<vf.reg<<", "<<srcReg<<std::endl;
+                    }
+                }
+                else if(context->FPArgCount>0 && context->ArgOffset<12){
                     if(vf.numBytes==1 && vf.isPtr==0)  {
                         file<<"sb $a"<<context->totalArgCount<<", "<<(context->stack.size - delta)<<"($sp)"<<std::endl;
                     }
@@ -166,6 +269,13 @@ class FunctionCallArgs : public FunctionArgs {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            action->regUsage(context);
+            if(next!=nullptr)   {
+                next->regUsage(context);
+            }
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             std::string type = action->getVarType(context);
             action->generate(file, "$t5", context);
@@ -182,74 +292,6 @@ class FunctionCallArgs : public FunctionArgs {
         }
 };
 
-class FunctionCall : public Program {   // function call 
-    private:
-        std::string id;
-        FunctionArgs *args=nullptr;
-    public:
-        FunctionCall(std::string *_id, FunctionArgs *_args) : id(*_id), args(_args)   {
-            delete _id;
-        }
-
-        virtual ~FunctionCall() {
-            delete args;
-        }
-        
-        virtual long spaceRequired(Context *context) const override {
-            if(args!=nullptr)   {
-                long count = args->getCount();
-                long space = (4*count)+8;
-                if(space<32)    {               // set minimum space required to 20 bytes to accomodate $a0 - $a3 and some padding
-                    space=32;
-                }
-                space+=args->spaceRequired(context);
-                return space;
-            }
-            else    {
-                return 32;
-            }
-        }
-        
-        virtual void print(std::ostream &dst) const override    {
-            dst<<id<<"(";
-            if(args!=nullptr)   {
-                args->print(dst);
-            }
-            dst<<");"<<std::endl;
-        }
-
-        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            long initSL = context->stack.slider;    // store previous context
-            long initSP = context->stack.size;
-            // long RAoffset = context->stack.slider;
-            long RAoffset = 24;
-            if(args!=nullptr)   {
-                if(args->getCount()>4)  {
-                    RAoffset = (4*args->getCount())+4;
-                }
-            }            
-            // file<<"sw $ra, "<<(context->stack.size - RAoffset)<<"($sp)"<<std::endl;    // store $ra
-            file<<"sw $ra, "<<RAoffset<<"($sp)"<<std::endl;
-
-            if(args!=nullptr)   {                           // load arguments (if any)
-                context->ArgCount=0;
-                args->generate(file, "$t0", context);
-                context->ArgCount=0;
-            }
-
-            file<<".option pic0"<<std::endl;
-            file<<"jal "<<id<<std::endl;                    // call function
-            file<<"nop"<<std::endl;
-            file<<".option pic2"<<std::endl;
-            file<<"move "<<std::string(destReg)<<", $v0"<<std::endl;    // store return value into destReg
-
-            // file<<"lw $ra, "<<(context->stack.size - RAoffset)<<"($sp)"<<std::endl;     // retore value of $ra
-            file<<"lw $ra, "<<RAoffset<<"($sp)"<<std::endl;
-            context->stack.slider = initSL;         // load previous context
-            context->stack.size = initSP;
-        }
-};
-
 class FunctionDef : public Program {    // function definition 
     private:
         std::string type; // return type of function
@@ -279,6 +321,50 @@ class FunctionDef : public Program {    // function definition
             return type;
         }
 
+        long paramCount() const  {
+            return (args==nullptr) ? 0 : args->getCount();
+        }
+
+        int inlineable() const  {           // body can be expanded at a call site
+            if(type=="float" || type=="double")  {
+                return 0;
+            }
+            return (args==nullptr) ? 1 : args->inlineable();
+        }
+
+        void inlineUsage(long start, Context *context) const    {  // register prepass over an inlined copy (arguments already scanned from start)
+            context->inlineStack.push_back(id);
+            context->regs.pushScope();
+            if(args!=nullptr)   {
+                args->inlineUsage(start, context);
+            }
+            action->regUsage(context);
+            context->regs.popScope();
+            context->inlineStack.pop_back();
+        }
+
+        void generateInline(std::ofstream &file, const char* destReg, const FunctionArgs *values, Context *context) const  {  // expand the body at a call site, returns branch to the end of the copy
+            long initSL = context->stack.slider;
+            int initIsFunc = context->isFunc;
+            std::string initFuncEnd = context->FuncRetnPoint;
+            std::unordered_map<std::string,varInfo> params;
+            if(args!=nullptr)   {
+                long slot = context->stack.slider;          // parameters, then the body's locals go on top of the caller's inside its frame
+                context->stack.slider += 4*args->inlineSlots(context);
+                args->generateInline(file, values, slot, params, context);
+            }
+            context->stack.lut.push_back(params);
+            context->inlineDepth++;
+            context->isFunc=1;                              // body scope places the return point like a function body
+            context->FuncRetnPoint = makeLabel("inline_end");
+            action->generate(file, destReg, context);
+            context->inlineDepth--;
+            context->stack.lut.pop_back();
+            context->stack.slider = initSL;
+            context->FuncRetnPoint = initFuncEnd;
+            context->isFunc = initIsFunc;
+        }
+
         void print(std::ostream &dst) const override    {
             dst<<getType()<<" "<<getID()<<"(";
             if(args!=nullptr)   {
@@ -305,15 +391,39 @@ class FunctionDef : public Program {    // function definition
             file << "   .ent	"<<getID()<<std::endl;
             file << "   .type	"<<getID()<<", @function"<<std::endl;
 
+            context->inlineSites.clear();
+            std::unordered_map<const void*,long> folded;        // locals found to hold their constant initializer, their reads fold
+            for(int round=0;;round++)   {                       // scanned again while folding the branches that use them finds more
+                context->regs.reset();                          // choose registers for the function's scalar variables
+                context->regs.constants = folded;
+                context->inlineStack.assign(1, getID());
+                context->inlineBudget = 4*context->inlineLimit;
+                context->regs.pushScope();
+                context->regs.body = action;
+                if(args!=nullptr)   {
+                    args->regUsage(context);
+                }
+                action->regUsage(context);
+                std::unordered_map<const void*,long> found = context->regs.constantLocals();
+                if(found.size()==folded.size() || round==RegAllocator::constantRounds)   {
+                    break;
+                }
+                folded = found;
+            }
+            context->regs.allocate();
+            std::vector<std::string> savedRegs = context->regs.savedRegs;   // callee-saved registers the body writes
+            if(context->regs.hasCall==1)    {                   // leaf functions never touch $ra
+                savedRegs.push_back("$ra");
+            }
+            long frameSize = 4+(4*savedRegs.size());            // padding word (first local of the body sits at its offset), then saved registers, no frame pointer
+            if(frameSize%8) {
+                frameSize+=8-(frameSize%8);
+            }
+
             context->FuncRetnPoint = makeLabel("func_end");
-            file<<getID()<<":"<<std::endl;                      // function start
-            file<<".set noreorder"<<std::endl;
-         
-            context->stack.size+=8;                            // allocate 8 bytes for $fp + padding, set context FP to old SP value
-            context->stack.slider = context->stack.size;
-            file<<"addiu $sp, $sp, -8"<<std::endl;             // allocate stack space for $fp
-            file<<"sw $fp, 4($sp)"<<std::endl;
-            file<<"move $fp, $sp"<<std::endl;
+            context->FrameRegs = savedRegs;
+            context->FrameSize = frameSize;
+            context->FuncEntryPoint = makeLabel("func_entry");
 
             std::unordered_map<std::string,functionInfo>::iterator it;  // add function to declared functions table
             it=context->ftable.find(getID());
@@ -324,45 +434,108 @@ class FunctionDef : public Program {    // function definition
                 it->second.returnType = getType();
             }            
             context->ftEntry = context->ftable.find(getID());
-            if(args!=nullptr)   {                                       // load arguments info into variable scope table (if any)
-                context->ArgCount=0;
-                context->FPArgCount=0;
-                context->ArgOffset=0;
-                context->totalArgCount =0;
+            if(args!=nullptr)   {
                 it->second.argCount = args->getCount();
-                args->generate(file, "$t0", context);
-                context->ArgCount=0;
-                context->FPArgCount=0;
-                context->ArgOffset=0;
-                context->totalArgCount =0;
             }
 
-            if (type == "float" || type == "double" ){
-                action->generate(file, "$f0", context);
-            } else {
-                action->generate(file, destReg, context);           // run function code
+            std::stringstream params;                           // buffer the code until the frame size is known
+            std::stringstream body;                             // (the body is also measured for inlining)
+            std::streambuf *fileBuf = static_cast<std::ostream&>(file).rdbuf();
+            size_t strings = context->strList.size();          // literals, jump tables and FP constants of discarded passes are dropped
+            size_t tables = context->jumpTables.size();
+            size_t constants = context->FP.size();
+            size_t argInfo = it->second.argList.size();
+            long locals = 0;
+            for(int pass=0;;pass++) {                           // the first pass only measures how much stack the body really uses
+                params.str("");
+                body.str("");
+                locals = context->stack.frameSize(action, action->spaceRequired(context));
+                if(locals%8)    {
+                    locals+=8-(locals%8);
+                }
+                context->stack.size = context->stack.FP + frameSize + locals;   // one frame for every nested scope, below the saved registers
+                FrameMark frame = context->stack.openFrame(context->stack.FP + frameSize);
+                context->stack.grown=0;
+                context->stack.lut.back().clear();
+                it->second.argList.resize(argInfo);
+                if(args!=nullptr)   {                                   // load arguments info into variable scope table (if any)
+                    static_cast<std::ostream&>(file).rdbuf(params.rdbuf());
+                    context->ArgCount=0;
+                    context->FPArgCount=0;
+                    context->ArgOffset=0;
+                    context->totalArgCount =0;
+                    args->generate(file, "$t0", context);
+                    context->ArgCount=0;
+                    context->FPArgCount=0;
+                    context->ArgOffset=0;
+                    context->totalArgCount =0;
+                }
+                static_cast<std::ostream&>(file).rdbuf(params.rdbuf());
+                context->globalAddr.clear();
+                std::unordered_map<const void*,std::vector<hoistEntry>>::iterator hoist = context->regs.hoists.find(action);
+                if(hoist!=context->regs.hoists.end())   {       // globals used repeatedly keep their address in a register for the whole body
+                    for(long i=0;i<hoist->second.size();i++)    {
+                        globalBase(file, hoist->second.at(i).reg, hoist->second.at(i).global, context);
+                        context->globalAddr[hoist->second.at(i).global] = hoist->second.at(i).reg;
+                    }
+                }
+                context->isFunc=1;
+                static_cast<std::ostream&>(file).rdbuf(body.rdbuf());
+                if (type == "float" || type == "double" ){
+                    action->generate(file, "$f0", context);
+                } else {
+                    action->generate(file, destReg, context);           // run function code
+                }
+                static_cast<std::ostream&>(file).rdbuf(fileBuf);
+                context->stack.closeFrame(action, locals, frame);
+                if(pass>0 && context->stack.grown==0)   {       // the frame fits what was measured
+                    break;
+                }
+                context->strList.resize(strings);
+                context->jumpTables.resize(tables);
+                context->FP.resize(constants);
             }
 
-            file<<"move $sp, $fp"<<std::endl;                   // deallocate stack space for $fp
-            file<<"lw $fp, 4($sp)"<<std::endl;
-            file<<"addiu $sp, $sp, 8"<<std::endl;
+            file<<getID()<<":"<<std::endl;                      // function start
+            file<<".set noreorder"<<std::endl;
+            file<<"addiu $sp, $sp, -"<<(frameSize + locals)<<std::endl;    // the only stack pointer adjustment until the epilogue
+            for(long i=0;i<savedRegs.size();i++)    {
+                file<<"sw "<<savedRegs.at(i)<<", "<<(locals+4+(4*i))<<"($sp)"<<std::endl;
+            }
+            file<<context->FuncEntryPoint<<":"<<std::endl;
+            file<<params.str();
+            file<<body.str();
+            it=context->ftable.find(getID());
+            it->second.def = this;
+            it->second.size = countInstructions(body.str());
+            it->second.hasCall = context->regs.hasCall;
+
+            for(long i=0;i<savedRegs.size();i++)    {
+                file<<"lw "<<savedRegs.at(i)<<", "<<(locals+4+(4*i))<<"($sp)"<<std::endl;
+            }
+            file<<"addiu $sp, $sp, "<<(frameSize + locals)<<std::endl;
             file<<"jr $ra"<<std::endl;                          // end of function, return to caller 
             file<<"nop"<<std::endl;
 
+            file<<".frame $sp, "<<(frameSize + locals)<<", $ra"<<std::endl;     // saved registers plus the body's locals, temporaries and argument area
             file<<".set reorder"<<std::endl;
             file << "    .end     "<<getID()<<std::endl;
             file<<".size    "<<getID()<<", .-"<<getID()<<std::endl<<std::endl;
             context->stack.lut.pop_back();                      // clear function argument scope
+            context->globalAddr.clear();
             context->isFunc=0;                                  // reload iniital context
             context->FuncRetnPoint = initFuncEnd;
             context->stack.slider = initSL;
             context->stack.size = initSP;
             context->stack.FP = initFP;
-            if (context->FP.size()!=0){
-                file << "     .data" << std::endl;
-            }
+            std::string section = "";
             while (context->FP.size() != 0) {
                 varInfo temp = context->FP.back();
+                std::string want = (isSmallData(temp.numBytes, context)==1) ? ".sdata" : ".data";    // where the load expects it
+                if (want != section){
+                    file << "     " << want << std::endl;
+                    section = want;
+                }
                 if (temp.numBytes== 8){
                     file << temp.FP_label << ":   .double " <<temp.FP_value<<std::endl;
                 }else if(temp.numBytes ==4){
@@ -400,4 +573,157 @@ class FunctionDef : public Program {    // function definition
         // }
 };
 
+class FunctionCall : public Program {   // function call 
+    private:
+        std::string id;
+        FunctionArgs *args=nullptr;
+    public:
+        FunctionCall(std::string *_id, FunctionArgs *_args) : id(*_id), args(_args)   {
+            delete _id;
+        }
+
+        virtual ~FunctionCall() {
+            delete args;
+        }
+        
+        int inlined(Context *context) const    {
+            std::unordered_map<const void*,int>::const_iterator site = context->inlineSites.find(this);
+            return (site!=context->inlineSites.end()) ? site->second : 0;
+        }
+
+        int shouldInline(int argCalls, Context *context) const   {   // callee already generated, small enough and not being expanded already
+            std::unordered_map<std::string,functionInfo>::iterator it = context->ftable.find(id);
+            if(argCalls==1 || it==context->ftable.end() || it->second.def==nullptr) {  // calls in the arguments would store into the inlined frame
+                return 0;
+            }
+            if(it->second.size > context->inlineLimit || it->second.size > context->inlineBudget)   {
+                return 0;
+            }
+            if(std::find(context->inlineStack.begin(), context->inlineStack.end(), id)!=context->inlineStack.end())  {
+                return 0;
+            }
+            if(context->returnedCall==this && it->second.hasCall==1)    {  // stays a tail call, the callee's own tail calls would become real calls in the copy
+                return 0;
+            }
+            const FunctionDef *callee = it->second.def;
+            if(callee->inlineable()==0 || callee->paramCount()!=((args==nullptr) ? 0 : args->getCount()))  {
+                return 0;
+            }
+            context->inlineBudget -= it->second.size;
+            return 1;
+        }
+
+        virtual long spaceRequired(Context *context) const override {
+            if(inlined(context)==1) {               // the copy allocates its own parameters and locals
+                return (args==nullptr) ? 0 : args->spaceRequired(context);
+            }
+            if(args!=nullptr)   {
+                long count = args->getCount();
+                long space = (4*count)+8;
+                if(space<32)    {               // set minimum space required to 20 bytes to accomodate $a0 - $a3 and some padding
+                    space=32;
+                }
+                space+=args->spaceRequired(context);
+                return space;
+            }
+            else    {
+                return 32;
+            }
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            long start = context->regs.position;
+            int hasCall = context->regs.hasCall;
+            context->regs.hasCall=0;
+            if(args!=nullptr)   {
+                args->regUsage(context);
+            }
+            int argCalls = context->regs.hasCall;
+            context->regs.hasCall = hasCall | argCalls;
+            if(context->inlineSites.find(this)==context->inlineSites.end()) {   // decided once, every copy of an inlined body agrees
+                context->inlineSites[this] = shouldInline(argCalls, context);
+            }
+            if(inlined(context)==1) {
+                context->ftable.find(id)->second.def->inlineUsage(start, context);
+            }
+            else    {
+                context->regs.hasCall=1;
+            }
+        }
+        
+        virtual void print(std::ostream &dst) const override    {
+            dst<<id<<"(";
+            if(args!=nullptr)   {
+                args->print(dst);
+            }
+            dst<<");"<<std::endl;
+        }
+
+        virtual int generateTailCall(std::ofstream &file, Context *context) const override  {   // return f(...): tear down the frame and jump
+            if(context->FuncRetnPoint=="" || context->regs.frameEscapes==1 || context->inlineDepth>0 || inlined(context)==1)  {
+                return 0;
+            }
+            std::string callerType = context->ftEntry->second.returnType;
+            std::string calleeType = "int";
+            std::unordered_map<std::string,functionInfo>::iterator it = context->ftable.find(id);
+            if(it!=context->ftable.end())   {
+                calleeType = it->second.returnType;
+            }
+            if(callerType=="float" || callerType=="double" || calleeType=="float" || calleeType=="double")   {
+                return 0;
+            }
+            if(args!=nullptr && (args->getCount()>4 || args->hasFPArgs(context)==1)) {    // stack arguments would land in the caller's frame
+                return 0;
+            }
+            if(args!=nullptr)   {
+                context->ArgCount=0;
+                args->generate(file, "$t0", context);
+                context->ArgCount=0;
+            }
+            long frameBase = context->stack.FP + context->FrameSize;
+            if(id==context->ftEntry->first) {               // self recursion: loop back to the entry with the new arguments, the frame is kept
+                file<<"b "<<context->FuncEntryPoint<<std::endl;
+                file<<"nop"<<std::endl;
+                return 1;
+            }
+            for(long i=0;i<context->FrameRegs.size();i++)   {
+                file<<"lw "<<context->FrameRegs.at(i)<<", "<<(context->stack.size - frameBase + 4+(4*i))<<"($sp)"<<std::endl;
+            }
+            file<<"addiu $sp, $sp, "<<(context->stack.size - context->stack.FP)<<std::endl;
+            file<<".option pic0"<<std::endl;
+            file<<"j "<<id<<std::endl;                      // callee returns straight to our caller
+            file<<"nop"<<std::endl;
+            file<<".option pic2"<<std::endl;
+            return 1;
+        }
+
+        virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(inlined(context)==1) {
+                context->ftable.find(id)->second.def->generateInline(file, destReg, args, context);
+                return;
+            }
+            long initSL = context->stack.slider;    // store previous context
+            long initSP = context->stack.size;      // $ra is saved once by the caller's prologue
+            long area = 16;                         // the callee may save $a0-$a3 in the bottom four words of the frame
+            if(args!=nullptr)   {                   // stack arguments follow them
+                area = std::max(area, ((args->hasFPArgs(context)==1) ? 8 : 4)*args->getCount());
+            }
+            context->stack.callArea = std::max(context->stack.callArea, area);
+
+            if(args!=nullptr)   {                           // load arguments (if any)
+                context->ArgCount=0;
+                args->generate(file, "$t0", context);
+                context->ArgCount=0;
+            }
+
+            file<<".option pic0"<<std::endl;
+            file<<"jal "<<id<<std::endl;                    // call function
+            file<<"nop"<<std::endl;
+            file<<".option pic2"<<std::endl;
+            file<<"move "<<std::string(destReg)<<", $v0"<<std::endl;    // store return value into destReg
+            context->stack.slider = initSL;         // load previous context
+            context->stack.size = initSP;
+        }
+};
+
 #endif
\ No newline at end of file
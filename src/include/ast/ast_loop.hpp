@@ -20,6 +20,37 @@ class Loop : public Program {
         ProgramPtr getAction() const    {
             return action;
         }
+
+        virtual int straightLine() const override    {
+            return 0;
+        }
+
+        void hoistInvariants(std::ofstream &file, Context *context) const  {   // preheader: compute the loop invariants chosen by the register prepass
+            std::unordered_map<const void*,std::vector<hoistEntry>>::iterator it = context->regs.hoists.find(this);
+            if(it==context->regs.hoists.end())  {
+                return;
+            }
+            for(long i=0;i<it->second.size();i++)   {
+                const hoistEntry &entry = it->second.at(i);
+                if(entry.kind!=hoistEntry::invariant)  {   // derived pointers are set up by the for loop
+                    continue;
+                }
+                if(entry.global!="")    {
+                    globalBase(file, entry.reg, entry.global, context);
+                    context->globalAddr[entry.global] = entry.reg;
+                }
+                else    {
+                    ProgramPtr node = static_cast<ProgramPtr>(entry.node);
+                    if(node->regNeed(context)>=ExprRegStack::opaque)    {   // pointer or FP arithmetic stays in the loop
+                        continue;
+                    }
+                    node->generate(file, entry.reg.c_str(), context);
+                    for(long a=0;a<entry.accesses.size();a++)   {   // every copy of the expression reads the register
+                        context->hoisted[entry.accesses.at(a)] = entry.reg;
+                    }
+                }
+            }
+        }
 };
 
 class WhileLoop : public Loop {
@@ -34,6 +65,15 @@ class WhileLoop : public Loop {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            long start = context->regs.loopStart(this);
+            getCondition()->regUsage(context);
+            if(getAction()!=nullptr)    {
+                getAction()->regUsage(context);
+            }
+            context->regs.loopEnd(start);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"while(";
             getCondition()->print(dst);
@@ -44,30 +84,37 @@ class WhileLoop : public Loop {
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             std::string initLoopStart = context->LoopStartPoint;
             std::string initLoopEnd = context->LoopEndPoint;
-            int initialIsLoop = context->isLoop;            // info for break; to handle stack deallocation
-            long initialLoopSP = context->LoopInitSP;
-            context->LoopInitSP = context->stack.size;
+            int initialIsLoop = context->isLoop;
             context->isLoop=1;
             int Switchinit = context->isSwitch;
             context->isSwitch = 0;
-            context->LoopStartPoint = makeLabel("Loop_Start");
+            std::string bodyPoint = makeLabel("Loop_Start");
+            context->LoopStartPoint = makeLabel("Loop_Continue");   // continue; re-tests the condition
             context->LoopEndPoint = makeLabel("Loop_End");
-            file<<context->LoopStartPoint<<":"<<std::endl;  // loop start
-            getCondition()->generate(file, "$t6", context);
-            file<<"beq $t6, $zero, "<<context->LoopEndPoint<<std::endl; // jump to loop end if condition == 0
-            file<<"nop"<<std::endl;
+            std::unordered_map<const void*,std::string> initHoisted = context->hoisted;
+            std::unordered_map<std::string,std::string> initGlobalAddr = context->globalAddr;
+            hoistInvariants(file, context);
+            getCondition()->generateBranch(file, context->LoopEndPoint, 0, context);   // guard: skip the loop if condition == 0
+            file<<bodyPoint<<":"<<std::endl;                // loop start
             getAction()->generate(file, destReg, context);  // loop action
-            file<<"b "<<context->LoopStartPoint<<std::endl; // jump to start of loop
-            file<<"nop"<<std::endl;
+            file<<context->LoopStartPoint<<":"<<std::endl;
+            getCondition()->generateBranch(file, bodyPoint, 1, context);   // jump back to start of loop if condition != 0
             file<<context->LoopEndPoint<<":"<<std::endl;    // loop end
+            context->hoisted = initHoisted;
+            context->globalAddr = initGlobalAddr;
             context->LoopStartPoint = initLoopStart;        // restore context variables to their original values 
             context->LoopEndPoint = initLoopEnd;
-            context->LoopInitSP = initialLoopSP;
             context->isLoop = initialIsLoop;
             context->isSwitch = Switchinit;
         }
 };
 
+struct inductionPointers {      // pointers derived from a for loop's counter
+    std::vector<std::string> regs;
+    std::vector<long> steps;
+    std::string end="";         // set if the exit test compares regs[0] against it, the counter is then no longer stepped
+};
+
 class ForLoop : public Loop  {      // for(dec; cond; asn) {...}
     private:
         ProgramPtr dec;
@@ -80,6 +127,255 @@ class ForLoop : public Loop  {      // for(dec; cond; asn) {...}
             delete asn;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            context->regs.pushScope();
+            dec->regUsage(context);
+            long exits = context->regs.loopExits;
+            long start = context->regs.loopStart(this);
+            ProgramPtr counter = nullptr;
+            ProgramPtr bound = nullptr;
+            if(getCondition()->countedBound(counter, bound)!=0 && asn->stepsUp()==counter->variableID())  {
+                context->regs.loops.back().counter = counter->variableID();
+            }
+            getCondition()->regUsage(context);
+            long body = context->regs.position;
+            if(getAction()!=nullptr)    {
+                getAction()->regUsage(context);
+            }
+            long bodyEnd = context->regs.position;
+            asn->regUsage(context);
+            context->regs.loopEnd(start);
+            long value;
+            if(getCondition()->countedBound(counter, bound)!=0 && asn->stepsUp()==counter->variableID())  {
+                countedLoop cl;
+                cl.loop = this;
+                cl.exits = (context->regs.loopExits!=exits) ? 1 : 0;
+                cl.counter = context->regs.lookup(counter->variableID());
+                cl.bound = (bound->getConstant(context, value)==1) ? -1 : context->regs.lookup(bound->variableID());
+                if(cl.bound==-1 && bound->getConstant(context, value)==0)   {   // globals and expressions may change behind the loop's back
+                    cl.bound = -2;
+                }
+                cl.start = start;
+                cl.end = context->regs.position-1;
+                cl.body = body;
+                cl.bodyEnd = bodyEnd;
+                if(cl.counter>=0)   {
+                    context->regs.counted.push_back(cl);
+                }
+            }
+            context->regs.popScope();
+        }
+
+        int plainCounter(ProgramPtr counter, ProgramPtr bound, Context *context) const  {   // counter and bound are ints (no pointer arithmetic)
+            long value;
+            if(counter->getVarType(context)!="int" || counter->getPointer(context)!=0)    {
+                return 0;
+            }
+            if(bound->getConstant(context, value)==0 && (bound->getVarType(context)!="int" || bound->getPointer(context)!=0))  {
+                return 0;
+            }
+            return 1;
+        }
+
+        int countedTrips(ProgramPtr &counter, ProgramPtr &bound, long &trips, Context *context) const   {   // kind of counted loop (see countedBound) if it may be unrolled, trips = -1 if only known at run time
+            const int unrollable = RegAllocator::counterStepped | RegAllocator::boundFixed | RegAllocator::noExits;
+            std::unordered_map<const void*,int>::iterator it = context->regs.countedFlags.find(this);
+            if(it==context->regs.countedFlags.end() || (it->second & unrollable)!=unrollable || context->unrollLimit<=0)  {
+                return 0;
+            }
+            int kind = getCondition()->countedBound(counter, bound);
+            long first, last;
+            if(plainCounter(counter, bound, context)==0)    {
+                return 0;
+            }
+            trips = -1;
+            ProgramPtr init = dec->assignedValue(counter->variableID());
+            if(init!=nullptr && init->getConstant(context, first)==1 && bound->getConstant(context, last)==1)  {
+                trips = last - first + ((kind==2) ? 1 : 0);
+                if(trips<=0)    {           // never entered, the guard handles it
+                    return 0;
+                }
+            }
+            return kind;
+        }
+
+        void derivePointers(std::ofstream &file, inductionPointers &pointers, Context *context) const {   // preheader: point the derived pointers at the elements of the first iteration
+            std::unordered_map<const void*,std::vector<hoistEntry>>::iterator it = context->regs.hoists.find(this);
+            ProgramPtr counter = nullptr;
+            ProgramPtr bound = nullptr;
+            int kind = getCondition()->countedBound(counter, bound);
+            if(it==context->regs.hoists.end() || kind==0)  {
+                return;
+            }
+            std::string end = "";
+            int complete = 1;
+            for(long i=0;i<it->second.size();i++)   {
+                const hoistEntry &entry = it->second.at(i);
+                if(entry.kind==hoistEntry::endPointer)  {
+                    end = entry.reg;
+                    continue;
+                }
+                if(entry.kind!=hoistEntry::derived) {
+                    continue;
+                }
+                long step;
+                ProgramPtr access = static_cast<ProgramPtr>(entry.accesses.at(0));
+                if(access->inductionAddress(file, entry.reg.c_str(), counter->variableID(), step, context)==0)  {
+                    complete = 0;
+                    continue;
+                }
+                for(long a=0;a<entry.accesses.size();a++)   {
+                    context->derived[entry.accesses.at(a)] = entry.reg;
+                }
+                pointers.regs.push_back(entry.reg);
+                pointers.steps.push_back(step);
+            }
+            if(end=="" || complete==0 || pointers.regs.size()==0 || plainCounter(counter, bound, context)==0)  {
+                return;
+            }
+            long step = pointers.steps.at(0);
+            if((step & (step-1))!=0 || step>4096)   {   // unrolled remainders are masked out of the pointer distance
+                return;
+            }
+            bound->generate(file, "$t0", context);
+            counter->generate(file, "$t8", context);
+            file<<"subu $t0, $t0, $t8"<<std::endl;             // iterations left (only used once the guard has passed)
+            if(kind==2) {
+                file<<"addiu $t0, $t0, 1"<<std::endl;
+            }
+            multiplyConstant(file, "$t0", "$t0", step, "$t8");
+            file<<"addu "<<end<<", "<<pointers.regs.at(0)<<", $t0"<<std::endl;
+            pointers.end = end;
+        }
+
+        void stepCounter(std::ofstream &file, ProgramPtr counter, Context *context) const  {   // counter++ between unrolled copies of the body
+            std::string reg = counter->getReg(context);
+            if(reg!="") {
+                file<<"addiu "<<reg<<", "<<reg<<", 1"<<std::endl;
+                return;
+            }
+            file<<"lw $t0, "<<counter->getOffset(context)<<"($sp)"<<std::endl;
+            file<<"addiu $t0, $t0, 1"<<std::endl;
+            file<<"sw $t0, "<<counter->getOffset(context)<<"($sp)"<<std::endl;
+        }
+
+        void stepLoop(std::ofstream &file, ProgramPtr counter, const inductionPointers &pointers, Context *context) const    {   // end of an iteration: asn and the derived pointers
+            if(pointers.end=="")    {
+                if(counter!=nullptr)    {
+                    stepCounter(file, counter, context);
+                }
+                else    {
+                    asn->generate(file, "$t4", context);    // conditional variable assignment (asn)
+                }
+            }
+            for(long i=0;i<pointers.regs.size();i++)    {
+                file<<"addiu "<<pointers.regs.at(i)<<", "<<pointers.regs.at(i)<<", "<<pointers.steps.at(i)<<std::endl;
+            }
+        }
+
+        void exitTest(std::ofstream &file, const std::string &label, const inductionPointers &pointers, Context *context) const  {  // jumps back to label while the loop condition holds
+            if(pointers.end!="")    {
+                file<<"bne "<<pointers.regs.at(0)<<", "<<pointers.end<<", "<<label<<std::endl;
+                file<<"nop"<<std::endl;
+                return;
+            }
+            getCondition()->generateBranch(file, label, 1, context);
+        }
+
+        void generateUnrolled(std::ofstream &file, const char* destReg, ProgramPtr counter, ProgramPtr bound, int kind, long trips, const std::string &bodyPoint, const inductionPointers &pointers, Context *context) const   {
+            std::stringstream body;                             // generate the first copy of the body to measure it
+            std::streambuf *fileBuf = static_cast<std::ostream&>(file).rdbuf(body.rdbuf());
+            getAction()->generate(file, destReg, context);
+            static_cast<std::ostream&>(file).rdbuf(fileBuf);
+            long copySize = countInstructions(body.str()) + pointers.regs.size();
+            if(pointers.end=="")    {
+                copySize += (counter->getReg(context)!="") ? 1 : 3;
+            }
+            long factor = 1;
+            if(trips>0 && trips*copySize<=context->unrollLimit) {
+                factor = trips;                                 // unroll completely
+            }
+            for(long k=8;k>=2 && factor==1;k/=2)    {
+                if(k*copySize<=context->unrollLimit && (trips<0 || k<=trips))    {
+                    factor = k;
+                }
+            }
+            if(factor==1)   {                                   // too big to copy: plain rotated loop
+                getCondition()->generateBranch(file, context->LoopEndPoint, 0, context);
+                file<<bodyPoint<<":"<<std::endl;
+                file<<body.str();
+                file<<context->LoopStartPoint<<":"<<std::endl;
+                stepLoop(file, counter, pointers, context);
+                exitTest(file, bodyPoint, pointers, context);
+                return;
+            }
+            long copies = factor;                               // copies of the body in the unrolled loop
+            if(trips==factor)   {
+                file<<body.str();
+                stepLoop(file, counter, pointers, context);
+                copies--;
+            }
+            else if(trips>0)    {                               // known trip count: the remainder runs straight before the loop
+                long remainder = trips % factor;
+                if(remainder>0) {
+                    file<<body.str();
+                    stepLoop(file, counter, pointers, context);
+                    for(long c=1;c<remainder;c++)   {
+                        getAction()->generate(file, destReg, context);
+                        stepLoop(file, counter, pointers, context);
+                    }
+                    file<<bodyPoint<<":"<<std::endl;
+                }
+                else    {
+                    file<<bodyPoint<<":"<<std::endl;
+                    file<<body.str();
+                    stepLoop(file, counter, pointers, context);
+                    copies--;
+                }
+            }
+            else    {                                           // run time bound: single iterations until the remaining trip count is a multiple of factor
+                std::string remainderPoint = makeLabel("Loop_Remainder");
+                std::string mainPoint = makeLabel("Loop_Unrolled");
+                getCondition()->generateBranch(file, context->LoopEndPoint, 0, context);
+                file<<remainderPoint<<":"<<std::endl;
+                if(pointers.end!="")    {
+                    file<<"subu $t0, "<<pointers.end<<", "<<pointers.regs.at(0)<<std::endl;    // bytes left
+                    file<<"andi $t0, $t0, "<<(factor*pointers.steps.at(0)-1)<<std::endl;
+                }
+                else    {
+                    bound->generate(file, "$t0", context);
+                    counter->generate(file, "$t8", context);
+                    file<<"subu $t0, $t0, $t8"<<std::endl;     // trips left (the counter is below the bound here)
+                    if(kind==2) {
+                        file<<"addiu $t0, $t0, 1"<<std::endl;
+                    }
+                    file<<"andi $t0, $t0, "<<(factor-1)<<std::endl;
+                }
+                file<<"beq $t0, $zero, "<<mainPoint<<std::endl;
+                file<<"nop"<<std::endl;
+                file<<body.str();
+                stepLoop(file, counter, pointers, context);
+                file<<"b "<<remainderPoint<<std::endl;
+                file<<"nop"<<std::endl;
+                file<<mainPoint<<":"<<std::endl;
+                if(pointers.end!="")    {
+                    file<<"beq "<<pointers.regs.at(0)<<", "<<pointers.end<<", "<<context->LoopEndPoint<<std::endl;
+                    file<<"nop"<<std::endl;
+                }
+                else    {
+                    getCondition()->generateBranch(file, context->LoopEndPoint, 0, context);
+                }
+                file<<bodyPoint<<":"<<std::endl;
+            }
+            for(long c=0;c<copies;c++)  {
+                getAction()->generate(file, destReg, context);
+                stepLoop(file, counter, pointers, context);
+            }
+            if(trips!=factor)   {
+                exitTest(file, bodyPoint, pointers, context);  // one test per factor iterations
+            }
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"for(";
             dec->print(dst);
@@ -95,46 +391,45 @@ class ForLoop : public Loop  {      // for(dec; cond; asn) {...}
             std::unordered_map<std::string,varInfo> tmp;
             std::string initLoopStart = context->LoopStartPoint;
             std::string initLoopEnd = context->LoopEndPoint;
-            std::string entryPoint = makeLabel("for_entry_point");
-            context->LoopStartPoint = makeLabel("Loop_Start");
+            std::string bodyPoint = makeLabel("Loop_Start");
+            context->LoopStartPoint = makeLabel("Loop_Continue");   // continue; runs asn then re-tests the condition
             context->LoopEndPoint = makeLabel("Loop_End");
-            int initialIsLoop = context->isLoop;            // info for break; to handle stack deallocation
-            long initialLoopSP = context->LoopInitSP;
-            long initialStackSize = context->stack.size;
-            long initialSliderValue = context->stack.slider;
+            int initialIsLoop = context->isLoop;
+            long initialSliderValue = context->stack.slider;   // loop variable goes on top of the enclosing scope's inside the function's frame
             context->isLoop=1;
             int Switchinit = context->isSwitch;
             context->isSwitch = 0;
-            long scopeSize = dec->spaceRequired(context);          // allocate new scope on stack for loop conditional variable
             context->stack.lut.push_back(tmp);
-            context->stack.slider = context->stack.size;
-            context->stack.size += scopeSize;
-            context->LoopInitSP = context->stack.size;
-            if(scopeSize>0) {
-                file<<"addiu $sp, $sp, -"<<scopeSize<<std::endl;
-            }
             dec->generate(file, "$t4", context);            // declare for loop variable (dec)
-            file<<"b "<<entryPoint<<std::endl;              // jump to entry point
-            file<<"nop"<<std::endl;
-            file<<context->LoopStartPoint<<":"<<std::endl;  // for loop start point
-            asn->generate(file, "$t4", context);            // conditional variable assignment (asn)
-            file<<entryPoint<<":"<<std::endl;               // for loop entry point
-            getCondition()->generate(file, "$t6", context);     // loop condition
-            file<<"beq $t6, $zero, "<<context->LoopEndPoint<<std::endl;
-            file<<"nop"<<std::endl;
-            getAction()->generate(file, destReg, context);
-            file<<"b "<<context->LoopStartPoint<<std::endl;     // jump to for loop start point
-            file<<"nop"<<std::endl;
-            file<<context->LoopEndPoint<<":"<<std::endl;        // for loop end point
-            if(scopeSize>0) {                                   // deallocate loop's scope from stack 
-                file<<"addiu $sp, $sp, "<<scopeSize<<std::endl;
+            std::unordered_map<const void*,std::string> initHoisted = context->hoisted;
+            std::unordered_map<std::string,std::string> initGlobalAddr = context->globalAddr;
+            std::unordered_map<const void*,std::string> initDerived = context->derived;
+            hoistInvariants(file, context);
+            inductionPointers pointers;
+            derivePointers(file, pointers, context);
+            ProgramPtr counter = nullptr;
+            ProgramPtr bound = nullptr;
+            long trips = 0;
+            int kind = countedTrips(counter, bound, trips, context);
+            if(kind==0) {
+                getCondition()->generateBranch(file, context->LoopEndPoint, 0, context);   // guard: skip the loop if the condition fails on entry
+                file<<bodyPoint<<":"<<std::endl;                // for loop start point
+                getAction()->generate(file, destReg, context);
+                file<<context->LoopStartPoint<<":"<<std::endl;
+                stepLoop(file, nullptr, pointers, context);
+                exitTest(file, bodyPoint, pointers, context);  // loop condition, jump back to for loop start point
+            }
+            else    {
+                generateUnrolled(file, destReg, counter, bound, kind, trips, bodyPoint, pointers, context);
             }
+            file<<context->LoopEndPoint<<":"<<std::endl;        // for loop end point
             context->stack.lut.pop_back();
+            context->hoisted = initHoisted;
+            context->globalAddr = initGlobalAddr;
+            context->derived = initDerived;
             context->LoopStartPoint = initLoopStart;        // restore context variables to their original values 
             context->LoopEndPoint = initLoopEnd;
-            context->stack.size = initialStackSize;
             context->stack.slider = initialSliderValue;
-            context->LoopInitSP = initialLoopSP;
             context->isLoop = initialIsLoop;
             context->isSwitch = Switchinit;
         }
@@ -9,6 +9,166 @@ class Operator : public Program {
         ProgramPtr right;
     protected:
         Operator(ProgramPtr _left, ProgramPtr _right) : left(_left), right(_right)  {}    
+
+        void storeLeft(std::ofstream &file, const char* srcReg, const char* tmpReg, Context *context) const {  // write srcReg back to the left operand (uses tempVarInfo of the left operand)
+            std::string type = getLeft()->getVarType(context);
+            std::string reg = getLeft()->getReg(context);
+            std::string src = std::string(srcReg);
+            std::string opcode = "sw";
+            if(src.substr(0,2)=="$f")   {
+                opcode = (type=="float") ? "s.s" : "s.d";
+            }
+            else if(type=="char" && !(context->tempVarInfo.isPtr==1 && context->tempVarInfo.derefPtr==0))  {
+                opcode = "sb";
+            }
+            if(context->tempVarInfo.derefPtr==1)    {   // store through the pointer
+                std::string ptrReg = reg;
+                if(reg=="") {
+                    file<<"lw "<<std::string(tmpReg)<<", "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
+                    ptrReg = std::string(tmpReg);
+                }
+                file<<opcode<<" "<<src<<", 0("<<ptrReg<<")"<<std::endl;
+            }
+            else if(reg!="")    {
+                file<<"move "<<reg<<", "<<src<<std::endl;
+            }
+            else    {
+                file<<opcode<<" "<<src<<", "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
+            }
+        }
+
+        virtual int fitsImmediate(long value) const  {  // can a constant right operand be encoded as an immediate
+            return 0;
+        }
+
+        virtual int isCommutative() const   {   // a constant left operand can be swapped into the immediate
+            return 0;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const  {  // does a constant operand on this side leave the other operand unchanged
+            return 0;
+        }
+
+        int constantOperands(Context *context, long &valueLeft, long &valueRight) const {  // returns 1 if both operands fold to constants
+            if(getRight()==nullptr) {
+                return 0;
+            }
+            if(getLeft()->getConstant(context, valueLeft)==0 || getRight()->getConstant(context, valueRight)==0)    {
+                return 0;
+            }
+            return 1;
+        }
+
+        ProgramPtr identityOperand(Context *context) const {   // operand the whole expression simplifies to (x+0, x*1, ...), nullptr if none
+            long value;
+            if(getRight()==nullptr) {
+                return nullptr;
+            }
+            if(getRight()->getConstant(context, value)==1 && isIdentity(value, 0)==1)   {
+                return getLeft();
+            }
+            if(getLeft()->getConstant(context, value)==1 && isIdentity(value, 1)==1)    {
+                return getRight();
+            }
+            return nullptr;
+        }
+
+        int operandsHoistable() const   {
+            return (left!=nullptr && right!=nullptr && left->hoistable()==1 && right->hoistable()==1) ? 1 : 0;
+        }
+
+        virtual int writesLeft() const  {   // the left operand is assigned (compound assignment, ++, --)
+            return 0;
+        }
+
+        int simplifiedNeed(Context *context) const {   // regNeed of a folded or simplified expression, -1 if it does not simplify
+            if(hoistedReg(context)!="") {               // computed before the loop
+                return 0;
+            }
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            ProgramPtr operand = identityOperand(context);
+            if(operand!=nullptr)    {
+                return operand->regNeed(context);
+            }
+            return -1;
+        }
+
+        int generateSimplified(std::ofstream &file, const char* destReg, Context *context) const {    // returns 1 if the expression folded or simplified away
+            std::string hoisted = hoistedReg(context);
+            if(hoisted!="") {
+                if(hoisted!=std::string(destReg))   {
+                    file<<"move "<<std::string(destReg)<<", "<<hoisted<<std::endl;
+                }
+                return 1;
+            }
+            if(generateConstant(file, destReg, context)==1) {
+                return 1;
+            }
+            ProgramPtr operand = identityOperand(context);
+            if(operand!=nullptr)    {
+                operand->generate(file, destReg, context);
+                return 1;
+            }
+            return 0;
+        }
+
+        int generateDivideConstant(std::ofstream &file, const char* destReg, int remainder, Context *context) const {   // integer / or % by a constant divisor, returns 0 if the divisor is not constant
+            long value;
+            if(getRight()->getConstant(context, value)==0 || value==0)  {
+                return 0;
+            }
+            int isUnsigned = getLeft()->getUnsigned(context);
+            std::string regLeft = evalOperand(file, getLeft(), context);
+            std::string acc = std::string(destReg);
+            if(acc==regLeft || acc=="$t8")  {       // quotient is built in the next register of the stack
+                acc = (context->exprRegs.available()>1) ? context->exprRegs.pool.at(context->exprRegs.depth+1) : "";
+            }
+            if(acc=="" || divideConstant(file, destReg, regLeft, value, isUnsigned, remainder, acc.c_str(), "$t8")==0) {
+                file<<"li $t8, "<<value<<std::endl;
+                file<<(isUnsigned==1 ? "divu " : "div ")<<regLeft<<", $t8"<<std::endl;
+                file<<(remainder==1 ? "mfhi " : "mflo ")<<std::string(destReg)<<std::endl;
+            }
+            return 1;
+        }
+
+        int binaryNeed(Context *context) const {    // Sethi-Ullman number of an integer binary operation
+            long value;
+            int need = simplifiedNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(getRight()->getConstant(context, value)==1 && fitsImmediate(value)==1)   {
+                return ExprRegStack::combine(getLeft()->regNeed(context), 0);
+            }
+            if(isCommutative()==1 && getLeft()->getConstant(context, value)==1 && fitsImmediate(value)==1)   {
+                return ExprRegStack::combine(getRight()->regNeed(context), 0);
+            }
+            return ExprRegStack::combine(getLeft()->regNeed(context), getRight()->regNeed(context));
+        }
+
+        void generateBinary(std::ofstream &file, const char* destReg, const char* opcode, const char* immOpcode, Context *context, int negate=0) const {   // opcode destReg, left, right
+            long value;
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
+            if(getRight()->getConstant(context, value)==1 && fitsImmediate(value)==1)   {
+                std::string regLeft = evalOperand(file, getLeft(), context);
+                file<<immOpcode<<" "<<std::string(destReg)<<", "<<regLeft<<", "<<(negate ? -value : value)<<std::endl;
+                return;
+            }
+            if(isCommutative()==1 && getLeft()->getConstant(context, value)==1 && fitsImmediate(value)==1)   {
+                std::string regRight = evalOperand(file, getRight(), context);
+                file<<immOpcode<<" "<<std::string(destReg)<<", "<<regRight<<", "<<value<<std::endl;
+                return;
+            }
+            std::string regLeft;
+            std::string regRight;
+            evalOperands(file, getLeft(), getRight(), regLeft, regRight, context);
+            file<<opcode<<" "<<std::string(destReg)<<", "<<regLeft<<", "<<regRight<<std::endl;
+        }
     public:
         virtual ~Operator() {
             delete left;
@@ -34,6 +194,40 @@ class Operator : public Program {
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            long reads = context->regs.reads.size();
+            long candidates = context->regs.candidates.size();
+            long commons = context->regs.commonUses.size();
+            if(left!=nullptr)   {
+                int writing = context->regs.writing;
+                context->regs.writing = writesLeft();
+                left->regUsage(context);
+                context->regs.writing = writing;
+            }
+            if(right!=nullptr)  {
+                right->regUsage(context);
+            }
+            long value;
+            if(hoistable()==1 && getConstant(context, value)==0)    {   // may be loop invariant, or computed more than once
+                std::stringstream key;
+                print(key);
+                context->regs.candidate(this, reads, candidates, key.str());
+                context->regs.commonUse(key.str(), this, 0, context->regs.commonUses.size()-commons+1, reads);   // operators inside add to the cost
+            }
+        }
+
+        virtual std::string getReg(Context *context) const override  {    // x+0 and friends live wherever x does
+            std::string hoisted = hoistedReg(context);
+            if(hoisted!="") {
+                return hoisted;
+            }
+            ProgramPtr operand = identityOperand(context);
+            if(operand!=nullptr)    {
+                return operand->getReg(context);
+            }
+            return "";
+        }
+
         virtual const char *getOpcode() const =0;
 
         virtual void print(std::ostream &dst) const override    {
@@ -55,7 +249,18 @@ class AssignmentOperator : public Operator {
             return getRight()->spaceRequired(context);
         }
 
+        virtual ProgramPtr assignedValue(const std::string &id) const override  {
+            return (getLeft()->variableID()==id) ? getRight() : nullptr;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            long value;
+            if(getLeft()->deadStore(context)==1)    {   // nothing reads the variable: only side effects of the value remain
+                if(getRight()->hoistable()==0 && getRight()->getConstant(context, value)==0)   {
+                    getRight()->generate(file, "$t0", context);
+                }
+                return;
+            }
             // long offset=getLeft()->getOffset(context);
             // std::string t=getLeft()->getVarType(context);
             int ptr_left = getLeft()->getPointer(context);
@@ -84,6 +289,10 @@ class AssignmentSumOperator : public Operator {
         virtual const char *getOpcode() const override  {
             return "+=";
         }
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         AssignmentSumOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
@@ -101,52 +310,22 @@ class AssignmentSumOperator : public Operator {
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
                     file<<"add.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 } else if(type == "double"){
                     file<<"add.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 }
             } else{
                 getRight()->generate(file,"$t2",context);
                 getLeft()->generate(file, "$t0", context);
                 if (context->tempVarInfo.isPtr==1){
-                    if (context->tempVarInfo.type == "double"){
-                        file<<"li $t1, 8"<<std::endl;
-                    } else {
-                        file<<"li $t1, "<<context->tempVarInfo.numBytes<<std::endl;
-                    }
-                    file<<"mult $t2, $t1"<<std::endl;
-                    file<<"mflo $t2"<<std::endl;
+                    long elementSize = (context->tempVarInfo.type == "double") ? 8 : context->tempVarInfo.numBytes;
+                    multiplyConstant(file, "$t2", "$t2", elementSize, "$t1");
                     file<<"addu $t2, $t0, $t2"<<std::endl;
                 }else {
                     file<<"addu $t2, $t0, $t2"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t2, 0($t0)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, 0($t0)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t2", "$t0", context);
             }
         }
 };
@@ -156,6 +335,10 @@ class AssignmentDiffOperator : public Operator {
         virtual const char *getOpcode() const override  {
             return "-=";
         }
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         AssignmentDiffOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
@@ -173,52 +356,22 @@ class AssignmentDiffOperator : public Operator {
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
                     file<<"sub.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 } else if(type == "double"){
                     file<<"sub.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 }
             } else{
                 getRight()->generate(file,"$t2",context);
                 getLeft()->generate(file, "$t0", context);
                 if (context->tempVarInfo.isPtr==1){
-                    if (context->tempVarInfo.type == "double"){
-                        file<<"li $t1, 8"<<std::endl;
-                    } else {
-                        file<<"li $t1, "<<context->tempVarInfo.numBytes<<std::endl;
-                    }
-                    file<<"mult $t2, $t1"<<std::endl;
-                    file<<"mflo $t2"<<std::endl;
+                    long elementSize = (context->tempVarInfo.type == "double") ? 8 : context->tempVarInfo.numBytes;
+                    multiplyConstant(file, "$t2", "$t2", elementSize, "$t1");
                     file<<"subu $t2, $t0, $t2"<<std::endl;
                 }else {
                     file<<"subu $t2, $t0, $t2"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t2, 0($t0)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, 0($t0)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t2", "$t0", context);
             }
         }
 };
@@ -228,6 +381,10 @@ class AssignmentProductOperator : public Operator {
         virtual const char *getOpcode() const override  {
             return "*=";
         }
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         AssignmentProductOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
@@ -245,43 +402,25 @@ class AssignmentProductOperator : public Operator {
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
                     file<<"mul.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 } else if(type == "double"){
                     file<<"mul.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 }
             } else{
+                long value;
+                if(getRight()->getConstant(context, value)==1)  {
+                    getLeft()->generate(file, "$t0", context);
+                    multiplyConstant(file, "$t2", "$t0", value, "$t1");
+                    storeLeft(file, "$t2", "$t0", context);
+                    return;
+                }
                 getRight()->generate(file,"$t2",context);
                 getLeft()->generate(file, "$t0", context);
                 file<<"mult $t2, $t0"<<std::endl;
                 file<<"mflo $t2"<<std::endl;
                 
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t2, 0($t0)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, 0($t0)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t2", "$t0", context);
             }
         }
 };
@@ -291,6 +430,10 @@ class AssignmentDivideOperator : public Operator {
         virtual const char *getOpcode() const override  {
             return "/=";
         }
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         AssignmentDivideOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
@@ -308,43 +451,30 @@ class AssignmentDivideOperator : public Operator {
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
                     file<<"div.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 } else if(type == "double"){
                     file<<"div.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                 }
             } else{
+                long value;
+                int isUnsigned = (getLeft()->getUnsigned(context)==1 || getRight()->getUnsigned(context)==1) ? 1 : 0;
+                if(getRight()->getConstant(context, value)==1)  {
+                    getLeft()->generate(file, "$t0", context);
+                    if(divideConstant(file, "$t2", "$t0", value, isUnsigned, 0, "$t2", "$t1")==0)  {
+                        file<<"li $t2, "<<value<<std::endl;
+                        file<<(isUnsigned==1 ? "divu " : "div ")<<"$t0, $t2"<<std::endl;
+                        file<<"mflo $t2"<<std::endl;
+                    }
+                    storeLeft(file, "$t2", "$t0", context);
+                    return;
+                }
                 getRight()->generate(file,"$t2",context);
                 getLeft()->generate(file, "$t0", context);
-                file<<"div $t2, $t0"<<std::endl;
+                file<<(isUnsigned==1 ? "divu " : "div ")<<"$t0, $t2"<<std::endl;     // left / right
                 file<<"mflo $t2"<<std::endl;
                 
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t2, 0($t0)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, 0($t0)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t2", "$t0", context);
             }
         }
 };
@@ -354,6 +484,10 @@ class AssignmentModOperator : public Operator {
         virtual const char *getOpcode() const override  {
             return "%=";
         }
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         AssignmentModOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
@@ -364,27 +498,24 @@ class AssignmentModOperator : public Operator {
         }
 
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getRight()->generate(file,"$t2",context);
-            getLeft()->generate(file, "$t0", context);
-            file<<"div $t0, $t2"<<std::endl;
-            file<<"mfhi $t2"<<std::endl;
-            
-            if(context->tempVarInfo.derefPtr==1){
-                file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                if(getLeft()->getVarType(context)=="int")  {
-                    file<<"sw $t2, 0($t0)"<<std::endl;
-                }
-                else if(getLeft()->getVarType(context)=="char")    {
-                    file<<"sb $t2, 0($t0)"<<std::endl;
-                }
-            } else { 
-                if(getLeft()->getVarType(context)=="int")  {
-                    file<<"sw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                }
-                else if(getLeft()->getVarType(context)=="char")    {
-                    file<<"sb $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
+            long value;
+            int isUnsigned = (getLeft()->getUnsigned(context)==1 || getRight()->getUnsigned(context)==1) ? 1 : 0;
+            if(getRight()->getConstant(context, value)==1)  {
+                getLeft()->generate(file, "$t0", context);
+                if(divideConstant(file, "$t2", "$t0", value, isUnsigned, 1, "$t2", "$t1")==0)  {
+                    file<<"li $t2, "<<value<<std::endl;
+                    file<<(isUnsigned==1 ? "divu " : "div ")<<"$t0, $t2"<<std::endl;
+                    file<<"mfhi $t2"<<std::endl;
                 }
             }
+            else    {
+                getRight()->generate(file,"$t2",context);
+                getLeft()->generate(file, "$t0", context);
+                file<<(isUnsigned==1 ? "divu " : "div ")<<"$t0, $t2"<<std::endl;
+                file<<"mfhi $t2"<<std::endl;
+            }
+            
+            storeLeft(file, "$t2", "$t0", context);
             file<<"move "<<std::string(destReg)<<", $t2"<<std::endl;
         }
 };
@@ -397,11 +528,51 @@ class AddOperator : public Operator {
     public:
         AddOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)   {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
         virtual std::string getVarType(Context *context) const override {
             return getLeft()->getVarType(context);
         }
 
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=-32768 && value<=32767) ? 1 : 0;
+        }
+
+        virtual int isCommutative() const override  {
+            return 1;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==0) {
+                return 0;
+            }
+            value = wrap(valueLeft + valueRight);
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            std::string type = getLeft()->getVarType(context);
+            int need = simplifiedNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(getLeft()->getPointer(context)==1 || getRight()->getPointer(context)==1 || type=="double" || type=="float")  {
+                return ExprRegStack::opaque;
+            }
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
             std::string type = getLeft()->getVarType(context);
             int ptr_left = getLeft()->getPointer(context);
             int ptr_right = getRight()->getPointer(context);
@@ -414,27 +585,17 @@ class AddOperator : public Operator {
                 getRight()->generate(file, "$t2", context);
                 varInfo varRight = context->tempVarInfo;
                 if (varLeft.isPtr==1 && varLeft.numBytes > 1) {
-                    if (varLeft.type == "double"){
-                        file<<"li $t3, 8"<<std::endl;
-                    } else {
-                        file<<"li $t3, "<<varLeft.numBytes<<std::endl;
-                    }
-                    file<<"mult $t2, $t3"<<std::endl;
-                    file<<"mflo $t2"<<std::endl;
+                    long elementSize = (varLeft.type == "double") ? 8 : varLeft.numBytes;
+                    multiplyConstant(file, "$t2", "$t2", elementSize, "$t3");
                     file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
                     context->stack.slider-=4;
                     file<<"addu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
                     context->tempVarInfo = varLeft;
 
                 } else if(varRight.isPtr==1 && varRight.numBytes > 1) {
-                    if (varLeft.type == "double"){
-                        file<<"li $t3, 8"<<std::endl;
-                    } else {
-                        file<<"li $t3, "<<varRight.numBytes<<std::endl;
-                    }
+                    long elementSize = (varLeft.type == "double") ? 8 : varRight.numBytes;
                     file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                    file<<"mult $t1, $t3"<<std::endl;
-                    file<<"mflo $t1"<<std::endl;
+                    multiplyConstant(file, "$t1", "$t1", elementSize, "$t3");
                     context->stack.slider-=4;
                     file<<"addu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
                 }else {
@@ -463,16 +624,7 @@ class AddOperator : public Operator {
                     file<<"add.d "<<std::string(destReg)<<", $f6, $f8"<<std::endl;
                 }
             }else {
-                getLeft()->generate(file, "$t1", context);
-                long ofs = context->stack.slider;
-                file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                context->stack.slider+=4;
-                varInfo varLeft = context->tempVarInfo;
-                getRight()->generate(file, "$t2", context);
-                varInfo varRight = context->tempVarInfo;
-                file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                context->stack.slider-=4;
-                file<<"addu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+                generateBinary(file, destReg, "addu", "addiu", context);
             }
 
 
@@ -487,12 +639,52 @@ class SubOperator : public Operator {
     public:
         SubOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)  {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
         virtual std::string getVarType(Context *context) const override {
             return getLeft()->getVarType(context);
         }
 
+        virtual int fitsImmediate(long value) const override  {
+            return (-value>=-32768 && -value<=32767) ? 1 : 0;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0 && onLeft==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==1) {
+                value = wrap(valueLeft - valueRight);
+                return 1;
+            }
+            if(sameValue(getLeft(), getRight(), context)==1)    {   // x - x
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            std::string type = getLeft()->getVarType(context);
+            int need = simplifiedNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(getLeft()->getPointer(context)==1 || getRight()->getPointer(context)==1 || type=="double" || type=="float")  {
+                return ExprRegStack::opaque;
+            }
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-                       std::string type = getLeft()->getVarType(context);
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
+            std::string type = getLeft()->getVarType(context);
             int ptr_left = getLeft()->getPointer(context);
             int ptr_right = getRight()->getPointer(context);
             if (ptr_left == 1 || ptr_right == 1){
@@ -504,27 +696,17 @@ class SubOperator : public Operator {
                 getRight()->generate(file, "$t2", context);
                 varInfo varRight = context->tempVarInfo;
                 if (varLeft.isPtr==1 && varLeft.numBytes > 1) {
-                    if (varLeft.type == "double"){
-                        file<<"li $t3, 8"<<std::endl;
-                    } else {
-                        file<<"li $t3, "<<varLeft.numBytes<<std::endl;
-                    }
-                    file<<"mult $t2, $t3"<<std::endl;
-                    file<<"mflo $t2"<<std::endl;
+                    long elementSize = (varLeft.type == "double") ? 8 : varLeft.numBytes;
+                    multiplyConstant(file, "$t2", "$t2", elementSize, "$t3");
                     file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
                     context->stack.slider-=4;
                     file<<"subu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
                     context->tempVarInfo = varLeft;
 
                 } else if(varRight.isPtr==1 && varRight.numBytes > 1) {
-                    if (varLeft.type == "double"){
-                        file<<"li $t3, 8"<<std::endl;
-                    } else {
-                        file<<"li $t3, "<<varRight.numBytes<<std::endl;
-                    }
+                    long elementSize = (varLeft.type == "double") ? 8 : varRight.numBytes;
                     file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                    file<<"mult $t1, $t3"<<std::endl;
-                    file<<"mflo $t1"<<std::endl;
+                    multiplyConstant(file, "$t1", "$t1", elementSize, "$t3");
                     context->stack.slider-=4;
                     file<<"subu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
                 }else {
@@ -553,16 +735,7 @@ class SubOperator : public Operator {
                     file<<"sub.d "<<std::string(destReg)<<", $f6, $f8"<<std::endl;
                 }
             }else {
-                getLeft()->generate(file, "$t1", context);
-                long ofs = context->stack.slider;
-                file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                context->stack.slider+=4;
-                varInfo varLeft = context->tempVarInfo;
-                getRight()->generate(file, "$t2", context);
-                varInfo varRight = context->tempVarInfo;
-                file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-                context->stack.slider-=4;
-                file<<"subu "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+                generateBinary(file, destReg, "subu", "addiu", context, 1);
             }
         }
 };
@@ -575,11 +748,56 @@ class MulOperator : public Operator {
     public:
         MulOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)   {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
         virtual std::string getVarType(Context *context) const override {
             return getLeft()->getVarType(context);
         }
 
+        virtual int fitsImmediate(long value) const override  {     // constant factors never take a register of the stack
+            return 1;
+        }
+
+        virtual int isCommutative() const override  {
+            return 1;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==1) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==1) {
+                value = wrap((unsigned int)valueLeft * (unsigned int)valueRight);
+                return 1;
+            }
+            if((getLeft()->getConstant(context, valueLeft)==1 && valueLeft==0 && isPure(getRight(), context)==1) ||
+               (getRight()->getConstant(context, valueRight)==1 && valueRight==0 && isPure(getLeft(), context)==1))  {   // x * 0
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            std::string type = getLeft()->getVarType(context);
+            int need = simplifiedNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(type=="double" || type=="float") {
+                return ExprRegStack::opaque;
+            }
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
             std::string type = getLeft()->getVarType(context);
             if (type == "double" || type == "float"){
                 getLeft()->generate(file, "$f6", context);
@@ -604,15 +822,24 @@ class MulOperator : public Operator {
                     file<<"mul.d "<<std::string(destReg)<<", $f6, $f8"<<std::endl;
                 }
             }else {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"mult $t1, $t2"<<std::endl;
-            file<<"mflo "<<std::string(destReg)<<std::endl;
+                long value;
+                ProgramPtr operand = nullptr;
+                if(getRight()->getConstant(context, value)==1)  {
+                    operand = getLeft();
+                }
+                else if(getLeft()->getConstant(context, value)==1)  {
+                    operand = getRight();
+                }
+                if(operand!=nullptr)    {           // multiply by a constant: shift/add sequence (or mult through $t8)
+                    std::string reg = evalOperand(file, operand, context);
+                    multiplyConstant(file, destReg, reg, value, "$t8");
+                    return;
+                }
+                std::string regLeft;
+                std::string regRight;
+                evalOperands(file, getLeft(), getRight(), regLeft, regRight, context);
+                file<<"mult "<<regLeft<<", "<<regRight<<std::endl;
+                file<<"mflo "<<std::string(destReg)<<std::endl;
             }
         }
 };
@@ -628,8 +855,36 @@ class DivOperator : public Operator {
         virtual std::string getVarType(Context *context) const override {
             return getLeft()->getVarType(context);
         }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==1 && onLeft==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {   // division by zero and INT_MIN / -1 are left to run time
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==0 || valueRight==0 || (valueLeft==-2147483648L && valueRight==-1))  {
+                return 0;
+            }
+            value = valueLeft / valueRight;
+            return 1;
+        }
         
+        virtual int regNeed(Context *context) const override  {
+            std::string type = getLeft()->getVarType(context);
+            int need = simplifiedNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(type=="double" || type=="float") {
+                return ExprRegStack::opaque;
+            }
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
             std::string type = getLeft()->getVarType(context);
             if (type == "double" || type == "float"){
                 getLeft()->generate(file, "$f6", context);
@@ -654,15 +909,15 @@ class DivOperator : public Operator {
                     file<<"div.d "<<std::string(destReg)<<", $f6, $f8"<<std::endl;
                 }
             }else {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"div $t1, $t2"<<std::endl;
-            file<<"mflo "<<std::string(destReg)<<std::endl;
+                if(generateDivideConstant(file, destReg, 0, context)==1)  {
+                    return;
+                }
+                std::string regLeft;
+                std::string regRight;
+                int isUnsigned = (getLeft()->getUnsigned(context)==1 || getRight()->getUnsigned(context)==1) ? 1 : 0;
+                evalOperands(file, getLeft(), getRight(), regLeft, regRight, context);
+                file<<(isUnsigned==1 ? "divu " : "div ")<<regLeft<<", "<<regRight<<std::endl;
+                file<<"mflo "<<std::string(destReg)<<std::endl;
             }
         }
 };
@@ -675,15 +930,38 @@ class ModuloOperator : public Operator {
     public:
         ModuloOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==1) {
+                if(valueRight==0 || (valueLeft==-2147483648L && valueRight==-1))    {
+                    return 0;
+                }
+                value = valueLeft % valueRight;
+                return 1;
+            }
+            if(getRight()->getConstant(context, valueRight)==1 && (valueRight==1 || valueRight==-1) && isPure(getLeft(), context)==1) {  // x % 1
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"div $t1, $t2"<<std::endl;
+            if(generateSimplified(file, destReg, context)==1)   {
+                return;
+            }
+            if(generateDivideConstant(file, destReg, 1, context)==1)  {
+                return;
+            }
+            std::string regLeft;
+            std::string regRight;
+            int isUnsigned = (getLeft()->getUnsigned(context)==1 || getRight()->getUnsigned(context)==1) ? 1 : 0;
+            evalOperands(file, getLeft(), getRight(), regLeft, regRight, context);
+            file<<(isUnsigned==1 ? "divu " : "div ")<<regLeft<<", "<<regRight<<std::endl;
             file<<"mfhi "<<std::string(destReg)<<std::endl;
         }
 };
@@ -710,6 +988,13 @@ class RefOperator : public Operator {
             return 1;
         }
 
+        virtual void regUsage(Context *context) const override  {  // variables whose address is taken stay on the stack
+            int takeAddress = context->regs.takeAddress;
+            context->regs.takeAddress=1;
+            getLeft()->regUsage(context);
+            context->regs.takeAddress=takeAddress;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             long offset = getLeft()->getOffset(context);
             std::unordered_map<std::string,structInfo>::iterator it;
@@ -753,6 +1038,10 @@ class DerefOperator : public Operator {
             return getLeft()->getOffset(context);
         }
 
+        virtual std::string getReg(Context *context) const override  { 
+            return getLeft()->getReg(context);
+        }
+
         virtual int getPointer(Context *context) const override  {  // returns offset from current $sp
             return 0;
         }
@@ -784,15 +1073,42 @@ class BitANDOperator : public Operator {
     public:
         BitANDOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=0 && value<=65535) ? 1 : 0;
+        }
+
+        virtual int isCommutative() const override  {
+            return 1;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==-1) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==1) {
+                value = valueLeft & valueRight;
+                return 1;
+            }
+            if((getLeft()->getConstant(context, valueLeft)==1 && valueLeft==0 && isPure(getRight(), context)==1) ||
+               (getRight()->getConstant(context, valueRight)==1 && valueRight==0 && isPure(getLeft(), context)==1))  {   // x & 0
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"and "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+            generateBinary(file, destReg, "and", "andi", context);
         }
 };
 
@@ -804,15 +1120,37 @@ class BitOROperator : public Operator {
     public:
         BitOROperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)     {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=0 && value<=65535) ? 1 : 0;
+        }
+
+        virtual int isCommutative() const override  {
+            return 1;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==0) {
+                return 0;
+            }
+            value = valueLeft | valueRight;
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"or "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+            generateBinary(file, destReg, "or", "ori", context);
         }
 };
 
@@ -824,15 +1162,41 @@ class BitXOROperator : public Operator {
     public:
         BitXOROperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=0 && value<=65535) ? 1 : 0;
+        }
+
+        virtual int isCommutative() const override  {
+            return 1;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==1) {
+                value = valueLeft ^ valueRight;
+                return 1;
+            }
+            if(sameValue(getLeft(), getRight(), context)==1)    {   // x ^ x
+                value = 0;
+                return 1;
+            }
+            return 0;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"xor "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+            generateBinary(file, destReg, "xor", "xori", context);
         }
 };
 
@@ -849,7 +1213,27 @@ class BitNOTOperator : public Operator {
             getLeft()->print(dst);
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft;
+            if(getLeft()->getConstant(context, valueLeft)==0)   {
+                return 0;
+            }
+            value = ~valueLeft;
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            return ExprRegStack::combine(getLeft()->regNeed(context), 0);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
             getLeft()->generate(file, destReg, context);
             file<<"nor "<<std::string(destReg)<<", "<<std::string(destReg)<<", "<<std::string(destReg)<<std::endl;
         }
@@ -871,8 +1255,32 @@ class NegOperator : public Operator {
             return getLeft()->getVarType(context);
         }
 
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft;
+            if(getLeft()->getConstant(context, valueLeft)==0)   {
+                return 0;
+            }
+            value = wrap(-valueLeft);
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            std::string type = getLeft()->getVarType(context);
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            if(type=="double" || type=="float") {
+                return ExprRegStack::opaque;
+            }
+            return ExprRegStack::combine(getLeft()->regNeed(context), 0);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             std::string type = getLeft()->getVarType(context);
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
             if (type == "double" || type == "float"){
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
@@ -881,8 +1289,8 @@ class NegOperator : public Operator {
                     file<<"neg.d "<<std::string(destReg)<<", $f6"<<std::endl;
                 }
             }else {
-            getLeft()->generate(file, "$t1", context);
-            file<<"subu "<<std::string(destReg)<<", $zero, $t1"<<std::endl;
+            std::string reg = evalOperand(file, getLeft(), context);
+            file<<"subu "<<std::string(destReg)<<", $zero, "<<reg<<std::endl;
             }
         }
 };
@@ -895,15 +1303,33 @@ class LeftShiftOperator : public Operator {
     public:
         LeftShiftOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)   {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=0 && value<=31) ? 1 : 0;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0 && onLeft==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {   // shift counts outside 0..31 are left to run time
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==0 || fitsImmediate(valueRight)==0)  {
+                return 0;
+            }
+            value = wrap((unsigned int)valueLeft << valueRight);
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"sllv "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+            generateBinary(file, destReg, "sllv", "sll", context);
         }
 };
 
@@ -915,15 +1341,33 @@ class RightShiftOperator : public Operator {
     public:
         RightShiftOperator(ProgramPtr _left, ProgramPtr _right) : Operator(_left,_right)    {}
 
+        virtual int hoistable() const override  {
+            return operandsHoistable();
+        }
+
+        virtual int fitsImmediate(long value) const override  {
+            return (value>=0 && value<=31) ? 1 : 0;
+        }
+
+        virtual int isIdentity(long value, int onLeft) const override  {
+            return (value==0 && onLeft==0) ? 1 : 0;
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {
+            long valueLeft, valueRight;
+            if(constantOperands(context, valueLeft, valueRight)==0 || fitsImmediate(valueRight)==0)  {
+                return 0;
+            }
+            value = (long)((int)valueLeft >> valueRight);
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return binaryNeed(context);
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
-            getLeft()->generate(file, "$t1", context);
-            long ofs = context->stack.slider;
-            file<<"sw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider+=4;
-            getRight()->generate(file, "$t2", context);
-            file<<"lw $t1, "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
-            context->stack.slider-=4;
-            file<<"srav "<<std::string(destReg)<<", $t1, $t2"<<std::endl;
+            generateBinary(file, destReg, "srav", "sra", context);
         }
 };
 
@@ -932,9 +1376,17 @@ class IncOperator : public Operator {   // i++
         virtual const char *getOpcode() const override  {
             return "++";
         }  
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         IncOperator(ProgramPtr _left) : Operator(_left,nullptr) {}
 
+        virtual std::string stepsUp() const override    {
+            return getLeft()->variableID();
+        }
+
         virtual void print(std::ostream &dst) const override    {
             getLeft()->print(dst);
             dst<<"++";
@@ -945,24 +1397,14 @@ class IncOperator : public Operator {   // i++
             if ((type == "double" || type == "float")&& ptr == 0){
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
-                    file<<"l.s $f8, ONE_Float"<<std::endl;
+                    file<<"l.s $f8, "<<constOperand("ONE_Float", 4, context)<<std::endl;
                     file<<"add.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.s "<<std::string(destReg)<<", $f6"<<std::endl;
                 } else if(type == "double"){
-                    file<<"l.d $f8, ONE_Double"<<std::endl;
+                    file<<"l.d $f8, "<<constOperand("ONE_Double", 8, context)<<std::endl;
                     file<<"add.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.d "<<std::string(destReg)<<", $f6"<<std::endl;
                 }
             } else{
@@ -976,22 +1418,7 @@ class IncOperator : public Operator {   // i++
                 }else {
                     file<<"addiu $t1, $t0, 1"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t1, 0($t2)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t1, 0($t2)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t1", "$t2", context);
                 if (std::string(destReg)!="$f0"){
                     file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
                 }
@@ -1004,6 +1431,10 @@ class DecOperator : public Operator {   // i--
         virtual const char *getOpcode() const override  {
             return "--";
         }  
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         DecOperator(ProgramPtr _left) : Operator(_left,nullptr) {}
 
@@ -1019,24 +1450,14 @@ class DecOperator : public Operator {   // i--
             if ((type == "double" || type == "float")&& ptr == 0){
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
-                    file<<"l.s $f8, ONE_Float"<<std::endl;
+                    file<<"l.s $f8, "<<constOperand("ONE_Float", 4, context)<<std::endl;
                     file<<"sub.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.s "<<std::string(destReg)<<", $f6"<<std::endl;
                 } else if(type == "double"){
-                    file<<"l.d $f8, ONE_Double"<<std::endl;
+                    file<<"l.d $f8, "<<constOperand("ONE_Double", 8, context)<<std::endl;
                     file<<"sub.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.d "<<std::string(destReg)<<", $f6"<<std::endl;
                 }
             } else{
@@ -1050,22 +1471,7 @@ class DecOperator : public Operator {   // i--
                 }else {
                     file<<"addiu $t1, $t0, -1"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t2, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t1, 0($t2)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t1, 0($t2)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t1", "$t2", context);
                 if (std::string(destReg)!="$f0"){
                     file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
                 }
@@ -1103,9 +1509,17 @@ class IncAfterOperator : public Operator {   // ++i
         virtual const char *getOpcode() const override  {
             return "++";
         }  
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         IncAfterOperator(ProgramPtr _left) : Operator(_left,nullptr) {}
 
+        virtual std::string stepsUp() const override    {
+            return getLeft()->variableID();
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"++";
             getLeft()->print(dst);
@@ -1117,24 +1531,14 @@ class IncAfterOperator : public Operator {   // ++i
             if ((type == "double" || type == "float")&& ptr == 0){
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
-                    file<<"l.s $f8, ONE_Float"<<std::endl;
+                    file<<"l.s $f8, "<<constOperand("ONE_Float", 4, context)<<std::endl;
                     file<<"add.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.s "<<std::string(destReg)<<", $f6"<<std::endl;
                 } else if(type == "double"){
-                    file<<"l.d $f8, ONE_Double"<<std::endl;
+                    file<<"l.d $f8, "<<constOperand("ONE_Double", 8, context)<<std::endl;
                     file<<"add.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.d "<<std::string(destReg)<<", $f8"<<std::endl;
                 }
             } else{
@@ -1148,22 +1552,7 @@ class IncAfterOperator : public Operator {   // ++i
                 }else {
                     file<<"addiu $t0, $t0, 1"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t0, 0($t1)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t0, 0($t1)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t0", "$t1", context);
                 if (std::string(destReg)!="$f0"){
                     file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
                 }
@@ -1176,6 +1565,10 @@ class DecAfterOperator : public Operator {   // --i
         virtual const char *getOpcode() const override  {
             return "--";
         }  
+
+        virtual int writesLeft() const override  {
+            return 1;
+        }
     public:
         DecAfterOperator(ProgramPtr _left) : Operator(_left,nullptr) {}
 
@@ -1190,24 +1583,14 @@ class DecAfterOperator : public Operator {   // --i
             if ((type == "double" || type == "float")&& ptr == 0){
                 getLeft()->generate(file, "$f6", context);
                 if (type == "float"){
-                    file<<"l.s $f8, ONE_Float"<<std::endl;
+                    file<<"l.s $f8, "<<constOperand("ONE_Float", 4, context)<<std::endl;
                     file<<"sub.s $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.s $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.s $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.s "<<std::string(destReg)<<", $f6"<<std::endl;
                 } else if(type == "double"){
-                    file<<"l.d $f8, ONE_Double"<<std::endl;
+                    file<<"l.d $f8, "<<constOperand("ONE_Double", 8, context)<<std::endl;
                     file<<"sub.d $f8, $f6, $f8"<<std::endl;
-                    if (context->tempVarInfo.derefPtr==1){
-                        file<<"lw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                        file<<"s.d $f8, 0($t0)"<<std::endl;
-                    } else {
-                        file<<"s.d $f8, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
+                    storeLeft(file, "$f8", "$t0", context);
                     file<<"mov.d "<<std::string(destReg)<<", $f8"<<std::endl;
                 }
             } else{
@@ -1221,22 +1604,7 @@ class DecAfterOperator : public Operator {   // --i
                 }else {
                     file<<"addiu $t0, $t0, -1"<<std::endl;
                 }
-                if(context->tempVarInfo.derefPtr==1){
-                    file<<"lw $t1, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    if(getLeft()->getVarType(context)=="int")  {
-                        file<<"sw $t0, 0($t1)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t0, 0($t1)"<<std::endl;
-                    }
-                } else { 
-                    if(getLeft()->getVarType(context)=="int"||getLeft()->getVarType(context)=="float"||getLeft()->getVarType(context)=="double")  {
-                        file<<"sw $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                    else if(getLeft()->getVarType(context)=="char")    {
-                        file<<"sb $t0, "<<getLeft()->getOffset(context)<<"($sp)"<<std::endl;
-                    }
-                }
+                storeLeft(file, "$t0", "$t1", context);
                 if (std::string(destReg)!="$f0"){
                     file<<"move "<<std::string(destReg)<<", $t0"<<std::endl;
                 }
@@ -54,11 +54,96 @@ class Variable : public Program {
             return "";
         }
 
+        virtual int getUnsigned(Context *context) const override {
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>=0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    if(it->second.isPtr==1 || it->second.isFP==1 || it->second.numBytes!=4) {
+                        return 0;
+                    }
+                    return (it->second.isUnsigned==1 || it->second.type=="unsigned") ? 1 : 0;
+                }
+            }
+            return 0;
+        }
+
+        virtual std::string getReg(Context *context) const override  {
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>=0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    if(it->second.isConst==1 && it->second.initValue==0)    {
+                        return "$zero";
+                    }
+                    return it->second.reg;
+                }
+            }
+            return "";
+        }
+
+        virtual int getConstant(Context *context, long &value) const override  {   // local only ever holding its constant initializer
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    value = it->second.initValue;
+                    return it->second.isConst;
+                }
+            }
+            return context->regs.constantOf(id, value);     // register prepass, the locals are not in the table yet
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            long value;
+            if(context->regs.writing==0 && context->regs.takeAddress==0 && context->regs.constantOf(id, value)==1)  {   // read folds to the constant
+                return;
+            }
+            context->regs.use(id);
+            noteGlobal(id, context);
+        }
+
+        virtual int hoistable() const override  {
+            return 1;
+        }
+
+        virtual std::string variableID() const override {
+            return id;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            int need = constantNeed(context);
+            if(need>=0) {
+                return need;
+            }
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>=0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    if(it->second.isFP==1)  {
+                        return ExprRegStack::opaque;
+                    }
+                    if(i>0 && it->second.reg!="")   {
+                        return 0;
+                    }
+                    return 1;
+                }
+            }
+            return ExprRegStack::opaque;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<id;
         }
 
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
+            if(generateConstant(file, destReg, context)==1) {
+                return;
+            }
             std::unordered_map<std::string,varInfo>::iterator it;
             int n=context->stack.lut.size()-1;   
             for(int i=n;i>=0;i--)   {
@@ -67,7 +152,12 @@ class Variable : public Program {
                     context->tempVarInfo = it->second;
                     if(i>0)    { //not global
                         long offset = context->stack.size - it->second.offset;
-                        if(context->tempVarInfo.isPtr==1) {
+                        if(it->second.reg!="")  {     // variable is held in a register
+                            if(it->second.reg!=std::string(destReg))    {
+                                file<<"move "<<std::string(destReg)<<", "<<it->second.reg<<std::endl;
+                            }
+                        }
+                        else if(context->tempVarInfo.isPtr==1) {
                             file<<"lw "<<std::string(destReg)<<", "<<offset<<"($sp)"<<std::endl;
                         }
                         else if(it->second.isFP ==1) {
@@ -92,21 +182,25 @@ class Variable : public Program {
                     }
                     else    {   // insert code for global variable reference
                         std::string id = it->first;
+                        std::string operand = (it->second.isSmall==1) ? "%gp_rel("+id+")($gp)" : "("+id+")";
                         if(it->second.isFP ==1) {
                             if(it->second.numBytes == 4){
-                                file<<"l.s "<<std::string(destReg)<<", ("<<id<<")"<<std::endl;
+                                file<<"l.s "<<std::string(destReg)<<", "<<operand<<std::endl;
                             }
                             if(it->second.numBytes == 8){
-                                file<<"l.d "<<std::string(destReg)<<", ("<<id<<")"<<std::endl;
+                                file<<"l.d "<<std::string(destReg)<<", "<<operand<<std::endl;
                             }
                             
                         }else {
-                            if(it->second.numBytes==1)    {
-                                file<<"lui "<<std::string(destReg)<<", \%hi("<<id<<")"<<std::endl;
-                                file<<"lbu "<<std::string(destReg)<<", \%lo("<<id<<")("<<std::string(destReg)<<")"<<std::endl;
+                            std::string opcode = (it->second.numBytes==1) ? "lbu " : "lw ";
+                            std::string addr = globalAddress(id, context);
+                            if(addr!="")    {           // address hoisted out of the loop
+                                file<<opcode<<std::string(destReg)<<", 0("<<addr<<")"<<std::endl;
+                            } else if(it->second.isSmall==1)    {
+                                file<<opcode<<std::string(destReg)<<", "<<operand<<std::endl;
                             } else {
                                 file<<"lui "<<std::string(destReg)<<", \%hi("<<id<<")"<<std::endl;
-                                file<<"lw "<<std::string(destReg)<<", \%lo("<<id<<")("<<std::string(destReg)<<")"<<std::endl;
+                                file<<opcode<<std::string(destReg)<<", \%lo("<<id<<")("<<std::string(destReg)<<")"<<std::endl;
                             }
                         }
                     }
@@ -160,6 +254,42 @@ class VariableStore : public Program {  // store vale into variable
         }
         
 
+        virtual std::string getReg(Context *context) const override  {
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>=0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    return it->second.reg;
+                }
+            }
+            return "";
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            int writing = context->regs.writing;
+            context->regs.writing = (ptr==0) ? 2 : 0;       // *p = x stores through p
+            context->regs.use(id);
+            context->regs.writing = writing;
+            noteGlobal(id, context);
+        }
+
+        virtual std::string variableID() const override {
+            return (ptr==0) ? id : "";
+        }
+
+        virtual int deadStore(Context *context) const override  {
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>0;i--)   {
+                it=context->stack.lut.at(i).find(getID());
+                if(it!=context->stack.lut.at(i).end()) {
+                    return (ptr==0) ? it->second.dead : 0;
+                }
+            }
+            return 0;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             if (getPtr() == 1){
                 dst<<"*";
@@ -175,7 +305,25 @@ class VariableStore : public Program {  // store vale into variable
                 if(it!=context->stack.lut.at(i).end()) {
                     context->tempVarInfo = it->second;
                     if(i>0)    { //not global (write to local variable
-                        if (getPtr()==0){
+                        std::string reg = it->second.reg;
+                        if (getPtr()==0 && reg!=""){
+                            if(reg!=std::string(destReg))   {
+                                file<<"move "<<reg<<", "<<std::string(destReg)<<std::endl;
+                            }
+                        } else if (getPtr()==1 && reg!=""){     // pointer held in a register
+                            if(it->second.numBytes==1)    {
+                                file<<"sb "<<destReg<<", 0("<<reg<<")"<<std::endl;
+                            }
+                            else if(it->second.isFP == 1 && it->second.type == "float"){
+                                file<<"s.s "<<destReg<<", 0("<<reg<<")"<<std::endl;
+                            }
+                            else if(it->second.isFP == 1 && it->second.type == "double"){
+                                file<<"s.d "<<destReg<<", 0("<<reg<<")"<<std::endl;
+                            }
+                            else    {
+                                file<<"sw "<<destReg<<", 0("<<reg<<")"<<std::endl;
+                            }
+                        } else if (getPtr()==0){
                             if(it->second.isFP == 1 && it->second.isPtr == 0){
                                 if (it->second.numBytes == 4){
                                     file <<"s.s "<<destReg<<", "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;
@@ -209,21 +357,26 @@ class VariableStore : public Program {  // store vale into variable
                         }
                     }
                     else    {   // insert code for storing to global variable reference
+                        std::string operand = (it->second.isSmall==1) ? "%gp_rel("+id+")($gp)" : "("+id+")";
                         if(it->second.isFP ==1) {
                             if(it->second.numBytes == 4){
-                                file<<"s.s "<<std::string(destReg)<<", ("<<id<<")"<<std::endl;
+                                file<<"s.s "<<std::string(destReg)<<", "<<operand<<std::endl;
                             }
                             if(it->second.numBytes == 8){
-                                file<<"s.d "<<std::string(destReg)<<", ("<<id<<")"<<std::endl;
+                                file<<"s.d "<<std::string(destReg)<<", "<<operand<<std::endl;
                             }
                         }else {
-                            if(it->second.numBytes==1)    {
-                                file<<"lui $t1, %hi("<<id<<")"<<std::endl;
-                                file<<"sb "<<std::string(destReg)<<", %lo("<<id<<")($t1)"<<std::endl;
+                            std::string opcode = (it->second.numBytes==1) ? "sb " : "sw ";
+                            std::string addr = globalAddress(id, context);
+                            if(addr!="")    {           // address hoisted out of the loop
+                                file<<opcode<<std::string(destReg)<<", 0("<<addr<<")"<<std::endl;
+                            }
+                            else if(it->second.isSmall==1)  {
+                                file<<opcode<<std::string(destReg)<<", "<<operand<<std::endl;
                             }
                             else    {
                                 file<<"lui $t1, %hi("<<id<<")"<<std::endl;
-                                file<<"sw "<<std::string(destReg)<<", %lo("<<id<<")($t1)"<<std::endl;
+                                file<<opcode<<std::string(destReg)<<", %lo("<<id<<")($t1)"<<std::endl;
                             }
                         }
                     }
@@ -236,9 +389,9 @@ class VariableStore : public Program {  // store vale into variable
 class ArrayIndex : public Program { // handle index for array access
     private:
         ProgramPtr value;
-        ProgramPtr next=nullptr;
+        ArrayIndex *next=nullptr;
     public:
-        ArrayIndex(ProgramPtr _value, ProgramPtr _next) : value(_value), next(_next)    {}
+        ArrayIndex(ProgramPtr _value, ArrayIndex *_next) : value(_value), next(_next)    {}
 
         ~ArrayIndex()   {
             delete value;
@@ -253,6 +406,13 @@ class ArrayIndex : public Program { // handle index for array access
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            value->regUsage(context);
+            if(next!=nullptr)   {
+                next->regUsage(context);
+            }
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<"[";
             value->print(dst);
@@ -262,25 +422,168 @@ class ArrayIndex : public Program { // handle index for array access
             }
         }
 
+        long blockSize(const varInfo &arrInfo, Context *context) const {   // bytes stepped over by one unit of this index
+            if (arrInfo.isPtr == 1){
+                return (arrInfo.type == "char") ? 1 : 4;
+            }
+            return context->vfPointer->blockSize.at(context->indexCounter);
+        }
+
+        int constantOffset(Context *context, long &offset) const {  // returns 1 and sets the byte offset if every index is a compile time constant
+            long val;
+            if(value->getConstant(context, val)==0) {
+                return 0;
+            }
+            offset = val * blockSize(context->tempVarInfo, context);
+            if(next!=nullptr)   {
+                long nextOffset;
+                context->indexCounter++;
+                int isConst = next->constantOffset(context, nextOffset);
+                context->indexCounter--;
+                if(isConst==0)  {
+                    return 0;
+                }
+                offset += nextOffset;
+            }
+            return 1;
+        }
+
+        int commonIndex(Context *context) const {   // 1 if every index is pure and one is not a compile time constant, -1 if one is impure
+            long val;
+            if(value->hoistable()==0 && value->getConstant(context, val)==0)    {
+                return -1;
+            }
+            int varying = (value->getConstant(context, val)==0) ? 1 : 0;
+            if(next!=nullptr)   {
+                int nextVarying = next->commonIndex(context);
+                if(nextVarying<0)   {
+                    return -1;
+                }
+                varying |= nextVarying;
+            }
+            return varying;
+        }
+
+        void commonUse(const std::string &id, const void *access, long readMark, Context *context) const {  // address of id[...] may be computed once for the statements around it
+            if(commonIndex(context)!=1) {
+                return;
+            }
+            if(context->regs.isLocal(id)==0)    {   // the address of a global array is fixed, a global pointer may change through calls
+                std::unordered_map<std::string,varInfo>::iterator it = context->stack.lut.at(0).find(id);
+                if(it==context->stack.lut.at(0).end() || it->second.dimension.size()==0)  {
+                    return;
+                }
+                readMark++;
+            }
+            std::stringstream key;
+            key<<id;
+            print(key);
+            context->regs.commonUse(key.str(), access, 1, 2, readMark);
+        }
+
+        int inductionDims(const std::string &counter, std::vector<std::string> &others, Context *context) const {  // indices equal to counter, -1 if another index is neither a variable nor a constant
+            int count=0;
+            long val;
+            if(value->variableID()==counter)    {
+                count++;
+            }
+            else if(value->getConstant(context, val)==0)    {
+                if(value->variableID()=="") {
+                    return -1;
+                }
+                others.push_back(value->variableID());
+            }
+            if(next!=nullptr)   {
+                int nextCount = next->inductionDims(counter, others, context);
+                if(nextCount<0) {
+                    return -1;
+                }
+                count += nextCount;
+            }
+            return count;
+        }
+
+        void inductionUse(const std::string &id, const void *access, Context *context) const {   // access id[...] inside a counted loop may walk a derived pointer
+            std::string counter = context->regs.innerCounter();
+            std::vector<std::string> others;
+            if(counter=="" || inductionDims(counter, others, context)!=1)   {
+                return;
+            }
+            std::stringstream key;
+            key<<id;
+            print(key);
+            context->regs.inductionUse(key.str(), access, id, others);
+        }
+
+        long inductionStep(const std::string &counter, Context *context) const {   // bytes the element address moves when counter goes up by one
+            long step = (value->variableID()==counter) ? blockSize(context->tempVarInfo, context) : 0;
+            if(next!=nullptr)   {
+                context->indexCounter++;
+                long nextStep = next->inductionStep(counter, context);
+                context->indexCounter--;
+                if(nextStep!=0) {
+                    step = nextStep;
+                }
+            }
+            return step;
+        }
+
+        int elementAddress(std::ofstream &file, const std::string &id, const char* destReg, const std::string &counter, long &step, Context *context) const {   // address of id[...] for the current index values (no step if counter is empty)
+            std::unordered_map<std::string,varInfo>::iterator it;
+            int n=context->stack.lut.size()-1;
+            for(int i=n;i>=0;i--)   {
+                it=context->stack.lut.at(i).find(id);
+                if(it==context->stack.lut.at(i).end())  {
+                    continue;
+                }
+                if((i==0 && it->second.dimension.size()==0) || it->second.isFP==1 || it->second.isStruct==1)  {  // a global pointer may change through calls
+                    return 0;
+                }
+                context->tempVarInfo = it->second;
+                context->vfPointer = &it->second;
+                context->indexCounter=0;
+                step = (counter!="") ? inductionStep(counter, context) : 0;
+                if(counter!="" && (step<=0 || step>32767))  {
+                    return 0;
+                }
+                generate(file, "$t8", context);         // element offset for the counter's initial value
+                std::string base;
+                if(i>0) {
+                    base = it->second.reg;
+                    if(base=="")    {
+                        file<<"lw $t5, "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;
+                        base = "$t5";
+                    }
+                }
+                else    {
+                    base = globalAddress(id, context);
+                    if(base=="")    {
+                        globalBase(file, destReg, id, context);
+                        base = std::string(destReg);
+                    }
+                }
+                file<<"addu "<<std::string(destReg)<<", "<<base<<", $t8"<<std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             varInfo arrInfo = context->tempVarInfo;
+            long offset;
+            if(constantOffset(context, offset)==1)  {
+                varInfo tmp;
+                context->tempVarInfo = tmp;
+                file<<"li "<<std::string(destReg)<<", "<<offset<<std::endl;
+                return;
+            }
             if(next!=nullptr)   {
                 context->indexCounter++;
                 next->generate(file, "$t9", context);
                 context->indexCounter--;
             }
             value->generate(file, "$t5", context);
-            if (arrInfo.isPtr == 1){
-                if(arrInfo.type == "int"){
-                    file<<"li $t4, 4"<<std::endl;
-                }else if(arrInfo.type == "char"){
-                    file<<"li $t4, 1"<<std::endl;
-                }
-            }else {
-                file<<"li $t4, "<<context->vfPointer->blockSize.at(context->indexCounter)<<std::endl;   // load block size (problematic line)
-            }
-            file<<"mult $t4, $t5"<<std::endl;
-            file<<"mflo "<<std::string(destReg)<<std::endl;
+            multiplyConstant(file, destReg, "$t5", blockSize(arrInfo, context), "$t4");   // scale by block size
             if(next!=nullptr)   {
                 file<<"addu "<<destReg<<", "<<destReg<<", $t9"<<std::endl;
             }
@@ -308,6 +611,25 @@ class Array : public Program {  // read value in array
             return index;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            int takeAddress = context->regs.takeAddress;    // &a[i] does not take the address of a or i
+            int writing = context->regs.writing;            // a[i] += x does not assign a or i
+            long readMark = context->regs.reads.size();
+            context->regs.takeAddress=0;
+            context->regs.writing=0;
+            context->regs.use(id);
+            noteGlobal(id, context);
+            index->regUsage(context);
+            index->inductionUse(id, this, context);
+            index->commonUse(id, this, readMark, context);
+            context->regs.takeAddress=takeAddress;
+            context->regs.writing=writing;
+        }
+
+        virtual int inductionAddress(std::ofstream &file, const char* destReg, const std::string &counter, long &step, Context *context) const override {
+            return index->elementAddress(file, id, destReg, counter, step, context);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<getID();
             index->print(dst);
@@ -322,31 +644,73 @@ class Array : public Program {  // read value in array
                     context->tempVarInfo = it->second;
                     context->vfPointer = &it->second;
                     context->indexCounter=0;
-                    index->generate(file, "$t8", context);  // load element relative offset into $t8
+                    long elementOffset = 0;
+                    std::string address;
+                    std::string derived = derivedPointer(context);
+                    if(derived!="") {                           // element address is stepped along with the loop counter
+                        address = "0("+derived+")";
+                        if(it->second.numBytes==1)    {
+                            file<<((it->second.isUnsigned==1) ? "lbu " : "lb ")<<std::string(destReg)<<", "<<address<<std::endl;
+                        }
+                        else    {
+                            file<<"lw "<<std::string(destReg)<<", "<<address<<std::endl;
+                        }
+                        break;
+                    }
+                    int constIndex = index->constantOffset(context, elementOffset);
+                    if(constIndex==0 || elementOffset<-32768 || elementOffset>32767)  {
+                        constIndex = 0;
+                        elementOffset = 0;
+                        index->generate(file, "$t8", context);  // load element relative offset into $t8
+                    }
+                    else    {                                   // constant index becomes the offset of the access
+                        varInfo tmp;
+                        context->tempVarInfo = tmp;
+                    }
                     if(i>0)    {
-                        file<<"lw $t5, "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;    // load array base address into $t5
-                        file<<"addu $t9, $t5, $t8"<<std::endl;      // add element offset to base address to get element address
+                        std::string base = it->second.reg;      // base address may be held in a register
+                        if(base=="")    {
+                            file<<"lw $t5, "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;    // load array base address into $t5
+                            base = "$t5";
+                        }
+                        if(constIndex==0)   {
+                            file<<"addu $t9, "<<base<<", $t8"<<std::endl;      // add element offset to base address to get element address
+                            base = "$t9";
+                        }
+                        address = std::to_string(elementOffset)+"("+base+")";
                         if(it->second.numBytes==1)    {
                             if(it->second.isUnsigned==1)    {
-                                file<<"lbu "<<std::string(destReg)<<", 0($t9)"<<std::endl;
+                                file<<"lbu "<<std::string(destReg)<<", "<<address<<std::endl;
                             }
                             else    {
-                                file<<"lb "<<std::string(destReg)<<", 0($t9)"<<std::endl;
+                                file<<"lb "<<std::string(destReg)<<", "<<address<<std::endl;
                             }                            
                         }
                         else    {
-                            file<<"lw "<<std::string(destReg)<<", 0($t9)"<<std::endl;   
+                            file<<"lw "<<std::string(destReg)<<", "<<address<<std::endl;   
                         }
                     }
                     else    {   // insert code for global variable reference
-                        file<<"lui "<<std::string(destReg)<<", %hi("<<getID()<<")"<<std::endl;
-                        file<<"addiu "<<std::string(destReg)<<", "<<std::string(destReg)<<", %lo("<<getID()<<")"<<std::endl;
-                        file<<"addu "<<std::string(destReg)<<", "<<std::string(destReg)<<", $t8"<<std::endl;
+                        std::string base = globalAddress(getID(), context);    // address may be hoisted out of the loop
+                        if(base=="" && constIndex==1 && it->second.isSmall==1)  {  // fixed element of a small array
+                            address = "%gp_rel("+getID()+"+"+std::to_string(elementOffset)+")($gp)";
+                        }
+                        else    {
+                            if(base=="")    {
+                                globalBase(file, destReg, getID(), context);
+                                base = std::string(destReg);
+                            }
+                            if(constIndex==0)   {
+                                file<<"addu "<<std::string(destReg)<<", "<<base<<", $t8"<<std::endl;
+                                base = std::string(destReg);
+                            }
+                            address = std::to_string(elementOffset)+"("+base+")";
+                        }
                         if(it->second.numBytes==1)    {
-                            file<<"lb "<<std::string(destReg)<<", 0("<<std::string(destReg)<<")"<<std::endl;
+                            file<<"lb "<<std::string(destReg)<<", "<<address<<std::endl;
                         }
                         else    {
-                            file<<"lw "<<std::string(destReg)<<", 0("<<std::string(destReg)<<")"<<std::endl;
+                            file<<"lw "<<std::string(destReg)<<", "<<address<<std::endl;
                         }
 
                     }
@@ -381,6 +745,25 @@ class ArrayStore : public Program {     // store value into array
             return 4;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            int takeAddress = context->regs.takeAddress;    // &a[i] does not take the address of a or i
+            int writing = context->regs.writing;            // a[i] += x does not assign a or i
+            long readMark = context->regs.reads.size();
+            context->regs.takeAddress=0;
+            context->regs.writing=0;
+            context->regs.use(id);
+            noteGlobal(id, context);
+            index->regUsage(context);
+            index->inductionUse(id, this, context);
+            index->commonUse(id, this, readMark, context);
+            context->regs.takeAddress=takeAddress;
+            context->regs.writing=writing;
+        }
+
+        virtual int inductionAddress(std::ofstream &file, const char* destReg, const std::string &counter, long &step, Context *context) const override {
+            return index->elementAddress(file, id, destReg, counter, step, context);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<getID();
             index->print(dst);
@@ -398,27 +781,60 @@ class ArrayStore : public Program {     // store value into array
                     context->tempVarInfo = it->second;
                     context->vfPointer = &it->second;
                     context->indexCounter=0;
-                    index->generate(file, "$t8", context);  // load element relative offset into $t8
+                    long elementOffset = 0;
+                    std::string address;
+                    std::string derived = derivedPointer(context);
+                    if(derived!="") {                           // element address is stepped along with the loop counter
+                        file<<"lw $t0, "<<(context->stack.size - offset)<<"($sp)"<<std::endl;
+                        file<<((it->second.numBytes==1) ? "sb" : "sw")<<" $t0, 0("<<derived<<")"<<std::endl;
+                        break;
+                    }
+                    int constIndex = index->constantOffset(context, elementOffset);
+                    if(constIndex==0 || elementOffset<-32768 || elementOffset>32767)  {
+                        constIndex = 0;
+                        elementOffset = 0;
+                        index->generate(file, "$t8", context);  // load element relative offset into $t8
+                    }
                     file<<"lw $t0, "<<(context->stack.size - offset)<<"($sp)"<<std::endl;
                     if(i>0)    {
-                        file<<"lw $t5, "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;    // load array base address into $t5
-                        file<<"addu $t9, $t5, $t8"<<std::endl;      // add element offset to base address to get element address
+                        std::string base = it->second.reg;      // base address may be held in a register
+                        if(base=="")    {
+                            file<<"lw $t5, "<<(context->stack.size - it->second.offset)<<"($sp)"<<std::endl;    // load array base address into $t5
+                            base = "$t5";
+                        }
+                        if(constIndex==0)   {
+                            file<<"addu $t9, "<<base<<", $t8"<<std::endl;      // add element offset to base address to get element address
+                            base = "$t9";
+                        }
+                        address = std::to_string(elementOffset)+"("+base+")";
                         if(it->second.numBytes==1)    {
-                            file<<"sb $t0, 0($t9)"<<std::endl;
+                            file<<"sb $t0, "<<address<<std::endl;
                         }
                         else    {
-                            file<<"sw $t0, 0($t9)"<<std::endl;
+                            file<<"sw $t0, "<<address<<std::endl;
                         }
                     }
                     else    {   // insert code for global variable reference
-                        file<<"lui $t1, %hi("<<getID()<<")"<<std::endl;
-                        file<<"addiu $t1, $t1, %lo("<<getID()<<")"<<std::endl;
-                        file<<"addu $t1, $t1, $t8"<<std::endl;
+                        std::string base = globalAddress(getID(), context);    // address may be hoisted out of the loop
+                        if(base=="" && constIndex==1 && it->second.isSmall==1)  {  // fixed element of a small array
+                            address = "%gp_rel("+getID()+"+"+std::to_string(elementOffset)+")($gp)";
+                        }
+                        else    {
+                            if(base=="")    {
+                                globalBase(file, "$t1", getID(), context);
+                                base = "$t1";
+                            }
+                            if(constIndex==0)   {
+                                file<<"addu $t1, "<<base<<", $t8"<<std::endl;
+                                base = "$t1";
+                            }
+                            address = std::to_string(elementOffset)+"("+base+")";
+                        }
                         if(it->second.numBytes==1)    {
-                            file<<"sb $t0, 0($t1)"<<std::endl;
+                            file<<"sb $t0, "<<address<<std::endl;
                         }
                         else    {
-                            file<<"sw $t0, 0($t1)"<<std::endl;
+                            file<<"sw $t0, "<<address<<std::endl;
                         }
                     }
                     break;
@@ -457,7 +873,7 @@ class Float : public Program {
             tmp.numBytes = 4;
             std::string FloatLabel = makeLabel("Float");
             tmp.FP_label = FloatLabel;
-            file<<"l.s "<<std::string(destReg)<<", "<<FloatLabel<<std::endl;
+            file<<"l.s "<<std::string(destReg)<<", "<<constOperand(FloatLabel, tmp.numBytes, context)<<std::endl;
             context->tempVarInfo = tmp;
             context->FP.push_back(tmp);
         }
@@ -491,7 +907,7 @@ class Double : public Program {
             tmp.numBytes = 8;
             std::string DoubleLabel = makeLabel("Double");
             tmp.FP_label = DoubleLabel;
-            file<<"l.d "<<std::string(destReg)<<", "<<DoubleLabel<<std::endl;
+            file<<"l.d "<<std::string(destReg)<<", "<<constOperand(DoubleLabel, tmp.numBytes, context)<<std::endl;
             context->tempVarInfo = tmp;
             context->FP.push_back(tmp);
         }
@@ -509,6 +925,28 @@ class Number : public Program {
             return value;
         }
 
+        virtual int getConstant(Context *context, long &val) const override  {
+            val = wrap(std::stoll(getValue(), nullptr, 0));
+            return 1;
+        }
+
+        virtual int hoistable() const override  {
+            return 1;
+        }
+
+        virtual std::string getReg(Context *context) const override  {
+            long val;
+            getConstant(context, val);
+            if(val==0)  {
+                return "$zero";
+            }
+            return "";
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return (getReg(context)=="") ? 1 : 0;
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<getValue();
         }
@@ -573,6 +1011,10 @@ class StructRead : public Program {
             delete element;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            context->regs.use(id);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<id<<".";
             element->print(dst);
@@ -633,6 +1075,10 @@ class StructStore : public Program {
             delete element;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            context->regs.use(id);
+        }
+
         virtual void print(std::ostream &dst) const override    {
             dst<<id<<".";
             element->print(dst);
@@ -688,6 +1134,15 @@ class OneCharacter : public Program {
             dst<<chr;
         }
 
+        virtual int getConstant(Context *context, long &val) const override  {
+            val = chr.substr(1,1).c_str()[0];
+            return 1;
+        }
+
+        virtual int regNeed(Context *context) const override  {
+            return 1;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             int value = chr.substr(1,1).c_str()[0];
             file<<"li "<<std::string(destReg)<<", "<<value<<std::endl;
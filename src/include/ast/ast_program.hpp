@@ -23,10 +23,65 @@ class Program {
             return 0;
         }
 
+        virtual int getUnsigned(Context *context) const {  // value is an unsigned int
+            return 0;
+        }
+
         virtual long spaceRequired(Context *context) const  {
             return 0;
         }
 
+        virtual std::string getReg(Context *context) const  {  // register holding the variable (if any)
+            return "";
+        }
+
+        virtual void regUsage(Context *context) const    {   // record variable uses for register allocation
+        }
+
+        virtual int regNeed(Context *context) const  {  // registers needed to evaluate (Sethi-Ullman number)
+            return ExprRegStack::opaque;
+        }
+
+        virtual int getConstant(Context *context, long &value) const  {   // returns 1 and sets value if node is a compile time constant
+            return 0;
+        }
+
+        virtual int hoistable() const   {   // pure integer arithmetic on variables and constants (no memory access, stores or calls)
+            return 0;
+        }
+
+        virtual std::string variableID() const  {   // name of the variable the node reads or writes directly (empty for anything else)
+            return "";
+        }
+
+        virtual ProgramPtr assignedValue(const std::string &id) const  {   // value a declaration or assignment of id stores (nullptr if it is not one)
+            return nullptr;
+        }
+
+        virtual int countedBound(ProgramPtr &counter, ProgramPtr &bound) const {   // counter < bound (returns 1) or counter <= bound (returns 2) with a plain variable as counter
+            return 0;
+        }
+
+        virtual std::string stepsUp() const    {   // variable incremented by one (i++ or ++i)
+            return "";
+        }
+
+        virtual int endsFlow(Context *context) const   {   // control never reaches the next statement (return, break, continue)
+            return 0;
+        }
+
+        virtual int deadStore(Context *context) const  {   // assignment target is a local that is never read
+            return 0;
+        }
+
+        virtual int straightLine() const    {   // statement without control flow of its own (values computed before it stay valid through it)
+            return 1;
+        }
+
+        virtual int inductionAddress(std::ofstream &file, const char* destReg, const std::string &counter, long &step, Context *context) const {  // array access: loads the element address into destReg and sets the bytes it moves per counter step, returns 0 if it cannot be derived (an empty counter only asks for the address)
+            return 0;
+        }
+
         virtual void print(std::ostream &dst) const =0;
 
         virtual void comparison(std::ofstream &file, const char* srcReg, Context *context) const   { // for switch case
@@ -36,6 +91,360 @@ class Program {
         virtual void generate(std::ofstream &file, const char*destReg, Context *context) const   {     // consider changing bindings to a struct containing the var and fn LUTs
             throw std::runtime_error("Not yet implemented"); 
         }
+
+        virtual int generateTailCall(std::ofstream &file, Context *context) const   {  // emits a returned call as a jump, returns 1 if it did
+            return 0;
+        }
+
+        virtual void generateBranch(std::ofstream &file, const std::string &label, int onTrue, Context *context) const   {  // jumps to label if the node's truth value equals onTrue, falls through otherwise
+            if(branchConstant(file, label, onTrue, context)==1) {
+                return;
+            }
+            std::string reg = "$t6";
+            std::string type = getVarType(context);
+            if(type=="float" || type=="double") {
+                generate(file, "$t6", context);
+            }
+            else    {
+                reg = evalOperand(file, this, context);
+            }
+            file<<(onTrue==1 ? "bne " : "beq ")<<reg<<", $zero, "<<label<<std::endl;
+            file<<"nop"<<std::endl;
+        }
+
+    protected:
+        static long countInstructions(const std::string &code)  {   // instructions in a buffer of generated code
+            std::stringstream lines(code);
+            std::string line;
+            long count=0;
+            while(std::getline(lines, line))    {
+                if(line!="" && line.at(0)!='.' && line.at(0)!=' ' && line.back()!=':')  {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        int generateConstant(std::ofstream &file, const char* destReg, Context *context) const {   // loads the folded value if the node is a compile time constant, returns 1 if it did
+            long value;
+            if(getConstant(context, value)==0)  {
+                return 0;
+            }
+            varInfo tmp;
+            context->tempVarInfo = tmp;
+            context->numVal = std::to_string(value);
+            file<<"li "<<std::string(destReg)<<", "<<value<<std::endl;
+            return 1;
+        }
+
+        int branchConstant(std::ofstream &file, const std::string &label, int onTrue, Context *context) const {    // folded condition: jumps unconditionally or not at all, returns 1 if the node is a compile time constant
+            long value;
+            if(getConstant(context, value)==0)  {
+                return 0;
+            }
+            if((value!=0 ? 1 : 0)==onTrue)  {
+                file<<"b "<<label<<std::endl;
+                file<<"nop"<<std::endl;
+            }
+            return 1;
+        }
+
+        int constantNeed(Context *context) const {  // registers needed if the node folds to a constant, -1 if it does not
+            long value;
+            if(getConstant(context, value)==0)  {
+                return -1;
+            }
+            return (value==0) ? 0 : 1;
+        }
+
+        void multiplyConstant(std::ofstream &file, const char* destReg, const std::string &srcReg, long value, const char* tmpReg) const {   // destReg = srcReg * value, tmpReg must differ from srcReg
+            static const int multiplyCost=5;            // li, mult and mflo plus the HI/LO latency
+            std::string dest = std::string(destReg);
+            std::vector<int> digits;                    // non-adjacent form of |value|, digit i is -1, 0 or 1
+            long magnitude = (value<0) ? -value : value;
+            while(magnitude!=0) {
+                int digit = 0;
+                if(magnitude & 1)   {
+                    digit = 2 - (int)(magnitude & 3);
+                    magnitude -= digit;
+                }
+                digits.push_back(digit);
+                magnitude >>= 1;
+            }
+            std::vector<int> positions;
+            for(int i=digits.size()-1;i>=0;i--) {
+                if(digits.at(i)!=0) {
+                    positions.push_back(i);
+                }
+            }
+            int cost = 2*((int)positions.size()-1) + (value<0 ? 1 : 0);
+            if(positions.size()>0 && positions.back()>0)    {
+                cost++;
+            }
+            if(value==0)    {
+                file<<"move "<<dest<<", $zero"<<std::endl;
+                return;
+            }
+            if(cost>multiplyCost)   {
+                file<<"li "<<std::string(tmpReg)<<", "<<value<<std::endl;
+                file<<"mult "<<srcReg<<", "<<std::string(tmpReg)<<std::endl;
+                file<<"mflo "<<dest<<std::endl;
+                return;
+            }
+            std::vector<std::string> ops;               // Horner evaluation over the digits, the partial product lives in acc
+            std::string acc = (dest==srcReg) ? std::string(tmpReg) : dest;
+            std::string accSrc = srcReg;
+            for(int i=1;i<positions.size();i++) {
+                ops.push_back("sll "+acc+", "+accSrc+", "+std::to_string(positions.at(i-1)-positions.at(i)));
+                ops.push_back(std::string(digits.at(positions.at(i))>0 ? "addu " : "subu ")+acc+", "+acc+", "+srcReg);
+                accSrc = acc;
+            }
+            if(positions.back()>0)  {
+                ops.push_back("sll "+acc+", "+accSrc+", "+std::to_string(positions.back()));
+                accSrc = acc;
+            }
+            if(value<0) {
+                ops.push_back("subu "+acc+", $zero, "+accSrc);
+                accSrc = acc;
+            }
+            if(ops.size()==0)   {                       // multiply by one
+                if(dest!=srcReg)    {
+                    file<<"move "<<dest<<", "<<srcReg<<std::endl;
+                }
+                return;
+            }
+            ops.back().replace(ops.back().find(acc), acc.size(), dest);    // last step writes the result register directly
+            for(int i=0;i<ops.size();i++)   {
+                file<<ops.at(i)<<std::endl;
+            }
+        }
+
+        int divideConstant(std::ofstream &file, const char* destReg, const std::string &srcReg, long divisor, int isUnsigned, int remainder, const char* accReg, const char* tmpReg) const {   // destReg = srcReg / divisor (or %), returns 0 if div has to be used
+            std::string dest = std::string(destReg);    // accReg and tmpReg must differ from srcReg and from each other
+            std::string acc = std::string(accReg);
+            std::string tmp = std::string(tmpReg);
+            unsigned long magnitude = (divisor<0) ? -divisor : divisor;
+            int log2 = -1;
+            if((magnitude & (magnitude-1))==0)  {
+                for(log2=0;(1UL<<log2)<magnitude;log2++)    {}
+            }
+            if(divisor==0 || (isUnsigned==1 && (divisor<0 || divisor>2147483647)))   {   // left to run time
+                return 0;
+            }
+            if(magnitude==1)    {
+                if(remainder==1)    {
+                    file<<"move "<<dest<<", $zero"<<std::endl;
+                }
+                else if(divisor<0)  {
+                    file<<"subu "<<dest<<", $zero, "<<srcReg<<std::endl;
+                }
+                else if(dest!=srcReg)   {
+                    file<<"move "<<dest<<", "<<srcReg<<std::endl;
+                }
+                return 1;
+            }
+            if(isUnsigned==1 && log2>0) {
+                if(remainder==0)    {
+                    file<<"srl "<<dest<<", "<<srcReg<<", "<<log2<<std::endl;
+                }
+                else if(magnitude-1<=65535) {
+                    file<<"andi "<<dest<<", "<<srcReg<<", "<<(magnitude-1)<<std::endl;
+                }
+                else    {
+                    file<<"sll "<<acc<<", "<<srcReg<<", "<<(32-log2)<<std::endl;
+                    file<<"srl "<<dest<<", "<<acc<<", "<<(32-log2)<<std::endl;
+                }
+                return 1;
+            }
+            if(log2>0)  {                               // signed power of two: bias negative values so the shift rounds towards zero
+                if(log2==1) {
+                    file<<"srl "<<tmp<<", "<<srcReg<<", 31"<<std::endl;
+                }
+                else    {
+                    file<<"sra "<<tmp<<", "<<srcReg<<", "<<(log2-1)<<std::endl;
+                    file<<"srl "<<tmp<<", "<<tmp<<", "<<(32-log2)<<std::endl;
+                }
+                file<<"addu "<<acc<<", "<<srcReg<<", "<<tmp<<std::endl;
+                if(remainder==1)    {
+                    file<<"sra "<<acc<<", "<<acc<<", "<<log2<<std::endl;
+                    file<<"sll "<<acc<<", "<<acc<<", "<<log2<<std::endl;
+                    file<<"subu "<<dest<<", "<<srcReg<<", "<<acc<<std::endl;
+                }
+                else if(divisor<0)  {
+                    file<<"sra "<<acc<<", "<<acc<<", "<<log2<<std::endl;
+                    file<<"subu "<<dest<<", $zero, "<<acc<<std::endl;
+                }
+                else    {
+                    file<<"sra "<<dest<<", "<<acc<<", "<<log2<<std::endl;
+                }
+                return 1;
+            }
+            std::string quotient = (remainder==1) ? acc : dest;
+            if(isUnsigned==1)   {
+                unsignedMagic mag = findUnsignedMagic(divisor);
+                file<<"li "<<tmp<<", "<<(long)(int)mag.multiplier<<std::endl;
+                file<<"multu "<<srcReg<<", "<<tmp<<std::endl;
+                if(mag.add==0)  {
+                    file<<"mfhi "<<(mag.shift>0 ? acc : quotient)<<std::endl;
+                    if(mag.shift>0) {
+                        file<<"srl "<<quotient<<", "<<acc<<", "<<mag.shift<<std::endl;
+                    }
+                }
+                else    {                               // multiplier needs 33 bits: q = (((n - t) >> 1) + t) >> (shift - 1)
+                    file<<"mfhi "<<acc<<std::endl;
+                    file<<"subu "<<tmp<<", "<<srcReg<<", "<<acc<<std::endl;
+                    file<<"srl "<<tmp<<", "<<tmp<<", 1"<<std::endl;
+                    file<<"addu "<<(mag.shift>1 ? acc : quotient)<<", "<<tmp<<", "<<acc<<std::endl;
+                    if(mag.shift>1) {
+                        file<<"srl "<<quotient<<", "<<acc<<", "<<(mag.shift-1)<<std::endl;
+                    }
+                }
+            }
+            else    {
+                signedMagic mag = findSignedMagic(divisor);
+                file<<"li "<<tmp<<", "<<mag.multiplier<<std::endl;
+                file<<"mult "<<srcReg<<", "<<tmp<<std::endl;
+                file<<"mfhi "<<acc<<std::endl;
+                if(divisor>0 && mag.multiplier<0)   {
+                    file<<"addu "<<acc<<", "<<acc<<", "<<srcReg<<std::endl;
+                }
+                else if(divisor<0 && mag.multiplier>0)  {
+                    file<<"subu "<<acc<<", "<<acc<<", "<<srcReg<<std::endl;
+                }
+                if(mag.shift>0) {
+                    file<<"sra "<<acc<<", "<<acc<<", "<<mag.shift<<std::endl;
+                }
+                file<<"srl "<<tmp<<", "<<(divisor>0 ? srcReg : acc)<<", 31"<<std::endl;    // add one to negative quotients
+                file<<"addu "<<quotient<<", "<<acc<<", "<<tmp<<std::endl;
+            }
+            if(remainder==1)    {                       // n - q * d
+                multiplyConstant(file, accReg, acc, divisor, tmpReg);
+                file<<"subu "<<dest<<", "<<srcReg<<", "<<acc<<std::endl;
+            }
+            return 1;
+        }
+
+        static long wrap(long value)    {   // truncate a folded value to a 32 bit int
+            return (long)(int)(unsigned int)value;
+        }
+
+        int isPure(ProgramPtr node, Context *context) const {  // nodes with a finite Sethi-Ullman number only read variables, so they can be dropped
+            return (node->regNeed(context) < ExprRegStack::opaque) ? 1 : 0;
+        }
+
+        int sameValue(ProgramPtr a, ProgramPtr b, Context *context) const {   // both operands are the same side effect free expression
+            if(isPure(a, context)==0 || isPure(b, context)==0)  {
+                return 0;
+            }
+            std::stringstream textA;
+            std::stringstream textB;
+            a->print(textA);
+            b->print(textB);
+            return (textA.str()==textB.str()) ? 1 : 0;
+        }
+
+        std::string hoistedReg(Context *context) const  {  // register holding this loop invariant expression ("" if it is not hoisted)
+            std::unordered_map<const void*,std::string>::iterator it = context->hoisted.find(this);
+            return (it!=context->hoisted.end()) ? it->second : "";
+        }
+
+        std::string derivedPointer(Context *context) const {   // register pointing at this array access's element inside the current loop ("" if none)
+            std::unordered_map<const void*,std::string>::iterator it = context->derived.find(this);
+            return (it!=context->derived.end()) ? it->second : "";
+        }
+
+        std::string globalAddress(const std::string &id, Context *context) const {   // register holding the global's address inside the current loop or function ("" if none)
+            std::unordered_map<std::string,std::string>::iterator it = context->globalAddr.find(id);
+            return (it!=context->globalAddr.end()) ? it->second : "";
+        }
+
+        void globalBase(std::ofstream &file, const std::string &reg, const std::string &id, Context *context) const {   // address of a global into reg
+            std::unordered_map<std::string,varInfo>::iterator it = context->stack.lut.at(0).find(id);
+            if(it!=context->stack.lut.at(0).end() && it->second.isSmall==1)  {
+                file<<"addiu "<<reg<<", $gp, %gp_rel("<<id<<")"<<std::endl;
+            }
+            else    {
+                file<<"lui "<<reg<<", %hi("<<id<<")"<<std::endl;
+                file<<"addiu "<<reg<<", "<<reg<<", %lo("<<id<<")"<<std::endl;
+            }
+        }
+
+        int isSmallData(long bytes, Context *context) const {  // fits the -G threshold: placed in .sdata/.sbss and reached from $gp in one instruction
+            return (bytes>0 && bytes<=context->smallData) ? 1 : 0;
+        }
+
+        std::string constOperand(const std::string &label, long bytes, Context *context) const {   // memory operand of an FP constant
+            return (isSmallData(bytes, context)==1) ? "%gp_rel("+label+")($gp)" : label;
+        }
+
+        void noteGlobal(const std::string &id, Context *context) const  {   // integer globals used in a loop or repeatedly get their address computed once
+            if(context->regs.isLocal(id)==1 || context->stack.lut.size()==0)  {
+                return;
+            }
+            std::unordered_map<std::string,varInfo>::iterator it = context->stack.lut.at(0).find(id);
+            if(it==context->stack.lut.at(0).end() || it->second.isFP==1 || it->second.isStruct==1)  {
+                return;
+            }
+            if(it->second.isSmall==1 && it->second.dimension.size()==0)  {    // small scalars are already a single $gp relative access
+                return;
+            }
+            context->regs.globalUse(id);
+        }
+
+        std::string evalOperand(std::ofstream &file, ProgramPtr operand, Context *context) const {   // returns register holding the operand's value
+            long value;
+            if(operand->getConstant(context, value)==1 && value==0)  {
+                return "$zero";
+            }
+            if(operand->regNeed(context)==0)    {       // already in a register (register variable or $zero)
+                return operand->getReg(context);
+            }
+            std::string reg = context->exprRegs.top();
+            operand->generate(file, reg.c_str(), context);
+            return reg;
+        }
+
+        void evalOperands(std::ofstream &file, ProgramPtr a, ProgramPtr b, std::string &regA, std::string &regB, Context *context) const {
+            int needA = a->regNeed(context);
+            int needB = b->regNeed(context);
+            if(needA==0 || needB==0)    {
+                regA = evalOperand(file, a, context);
+                regB = evalOperand(file, b, context);
+                return;
+            }
+            ProgramPtr first = a;                   // evaluate the operand needing more registers first
+            ProgramPtr second = b;
+            if(needB>needA) {
+                first = b;
+                second = a;
+            }
+            std::string regFirst;
+            std::string regSecond;
+            if(second->regNeed(context) < context->exprRegs.available())    {
+                regFirst = evalOperand(file, first, context);
+                context->exprRegs.depth++;          // keep first result live on the register stack
+                regSecond = evalOperand(file, second, context);
+                context->exprRegs.depth--;
+            }
+            else    {                               // not enough registers (or both sides clobber scratch registers): spill first result
+                regFirst = evalOperand(file, first, context);
+                long ofs = context->stack.slider;
+                file<<"sw "<<regFirst<<", "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
+                context->stack.slider+=4;
+                regSecond = evalOperand(file, second, context);
+                regFirst = context->exprRegs.pool.at(context->exprRegs.depth+1);
+                file<<"lw "<<regFirst<<", "<<(context->stack.size - ofs)<<"($sp)"<<std::endl;
+                context->stack.slider-=4;
+            }
+            if(first==a)    {
+                regA = regFirst;
+                regB = regSecond;
+            }
+            else    {
+                regA = regSecond;
+                regB = regFirst;
+            }
+        }
 };
 
 class Command : public Program { //each line of a program is a command, it is wrapper to make things into a linked list
@@ -52,12 +461,73 @@ class Command : public Program { //each line of a program is a command, it is wr
 
         virtual long spaceRequired(Context *context) const override {
             long tmp = action->spaceRequired(context);
-            if(next!=nullptr)   {
+            if(next!=nullptr && action->endsFlow(context)==0)   {   // statements after a return, break or continue are never generated
                 tmp += next->spaceRequired(context);
             }
             return tmp;
         }
 
+        virtual void regUsage(Context *context) const override  {
+            int last = (next==nullptr || action->endsFlow(context)==1) ? 1 : 0;
+            context->regs.statementStart(this, (action->straightLine()==1 && context->inlineStack.size()<=1) ? 1 : 0);
+            action->regUsage(context);
+            context->regs.statementEnd(last);
+            if(last==0) {
+                next->regUsage(context);
+            }
+        }
+
+        virtual int endsFlow(Context *context) const override  {
+            return (action->endsFlow(context)==1 || (next!=nullptr && next->endsFlow(context)==1)) ? 1 : 0;
+        }
+
+        void commonValues(std::ofstream &file, Context *context) const  {   // values the register prepass found computed more than once in the run starting here
+            std::unordered_map<const void*,std::vector<hoistEntry>>::iterator it = context->regs.hoists.find(this);
+            if(it==context->regs.hoists.end())  {
+                return;
+            }
+            for(long i=0;i<it->second.size();i++)   {
+                const hoistEntry &entry = it->second.at(i);
+                ProgramPtr node = static_cast<ProgramPtr>(entry.node);
+                long step;
+                if(entry.kind==hoistEntry::commonAddress)  {
+                    if(node->inductionAddress(file, entry.reg.c_str(), "", step, context)==0)  {
+                        continue;
+                    }
+                    for(long a=0;a<entry.accesses.size();a++)   {
+                        context->derived[entry.accesses.at(a)] = entry.reg;
+                    }
+                }
+                else if(entry.kind==hoistEntry::commonValue)    {
+                    if(node->regNeed(context)>=ExprRegStack::opaque)    {   // pointer or FP arithmetic
+                        continue;
+                    }
+                    node->generate(file, entry.reg.c_str(), context);
+                    for(long a=0;a<entry.accesses.size();a++)   {
+                        context->hoisted[entry.accesses.at(a)] = entry.reg;
+                    }
+                }
+                else    {
+                    continue;
+                }
+                context->commonLive.push_back(entry);
+            }
+        }
+
+        void releaseValues(Context *context) const  {  // registers of the values last read by this statement are free again
+            for(long i=context->commonLive.size()-1;i>=0;i--)   {
+                const hoistEntry &entry = context->commonLive.at(i);
+                if(entry.until!=this)   {
+                    continue;
+                }
+                for(long a=0;a<entry.accesses.size();a++)   {
+                    context->derived.erase(entry.accesses.at(a));
+                    context->hoisted.erase(entry.accesses.at(a));
+                }
+                context->commonLive.erase(context->commonLive.begin()+i);
+            }
+        }
+
         virtual void print(std::ostream &dst) const override    {
             action->print(dst);
             dst<<std::endl;
@@ -67,15 +537,14 @@ class Command : public Program { //each line of a program is a command, it is wr
         }
 
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
-            if(context->stack.lut.size()==0) {
+            if(context->stack.lut.size()==0) {      // global scope, each function allocates its own frame
                 std::unordered_map<std::string,varInfo> tmp;
                 context->stack.lut.push_back(tmp);
-                long stackSize = spaceRequired(context);
-                context->stack.size = stackSize;
-                file<<"addiu $sp, $sp, -"<<stackSize<<std::endl;
             }
+            commonValues(file, context);
             action->generate(file, destReg, context);
-            if(next!=nullptr)   {
+            releaseValues(context);
+            if(next!=nullptr && action->endsFlow(context)==0)   {  // unreachable
                 next->generate(file, destReg, context);
             }
         }
@@ -99,29 +568,34 @@ class Scope : public Program {
             dst<<std::endl<<"}"<<std::endl;
         }
 
+        virtual int endsFlow(Context *context) const override  {
+            return (action!=nullptr) ? action->endsFlow(context) : 0;
+        }
+
+        virtual int straightLine() const override    {
+            return 0;
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            if(action!=nullptr) {
+                context->regs.pushScope();
+                action->regUsage(context);
+                context->regs.popScope();
+            }
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override {
             if(action!=nullptr) {
                 std::unordered_map<std::string,varInfo> tmp;
                 int isFunc = context->isFunc;
                 context->isFunc=0;
-                long initStackSize = context->stack.size;
-                long initSliderVal=context->stack.slider;
-                context->stack.slider=context->stack.size;
-                long delta=action->spaceRequired(context);
-                context->stack.size+=delta;
-                if(delta>0) {
-                    file<<"addiu $sp, $sp, -"<<delta<<std::endl;
-                }
+                long initSliderVal=context->stack.slider;  // locals go on top of the enclosing scope's inside the function's frame
                 context->stack.lut.push_back(tmp);
                 action->generate(file, destReg, context);          // run scope contents
                 if(isFunc==1)   {
                     file<<context->FuncRetnPoint<<":"<<std::endl;
                 }
-                if(delta>0)    {
-                    file<<"addiu $sp, $sp, "<<delta<<std::endl;    // shift down the stack pointer (always move sp by 4 to maintain word alignment)
-                }
-                context->stack.size=initStackSize;
-                context->stack.slider=initSliderVal;
+                context->stack.slider=initSliderVal;                // sibling scopes reuse the same slots
                 context->stack.lut.pop_back();
             }            
         }
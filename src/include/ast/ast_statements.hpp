@@ -36,8 +36,22 @@ class ReturnStatement : public Program {
             }
         }
 
+        virtual int endsFlow(Context *context) const override  {
+            return 1;
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            if(getAction()!=nullptr)    {
+                context->returnedCall = getAction();
+                getAction()->regUsage(context);
+            }
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             if(context->FuncRetnPoint!="")  {                
+                if(getAction()!=nullptr && getAction()->generateTailCall(file, context)==1)  {
+                    return;
+                }
                 if(getAction()!=nullptr)    {
                     getAction()->generate(file, destReg, context);
                 }
@@ -53,13 +67,20 @@ class BreakStatement : public Program {
             dst<<"break;"<<std::endl;
         }
 
+        virtual int endsFlow(Context *context) const override  {
+            return 1;
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            context->regs.loopExits++;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             if(context->BranchEndPoint!="" && context->isSwitch == 1) {
                 file<<"b "<<context->BranchEndPoint<<std::endl;
                 file<<"nop"<<std::endl;
             }
             if(context->LoopEndPoint!="" && context->isLoop ==1)  {
-                file<<"addiu $sp, $sp, "<<(context->stack.size - context->LoopInitSP)<<std::endl;
                 file<<"b "<<context->LoopEndPoint<<std::endl;
                 file<<"nop"<<std::endl;
             }
@@ -72,9 +93,16 @@ class ContinueStatement : public Program {
             dst<<"continue;"<<std::endl;
         }
 
+        virtual int endsFlow(Context *context) const override  {
+            return 1;
+        }
+
+        virtual void regUsage(Context *context) const override  {
+            context->regs.loopExits++;
+        }
+
         virtual void generate(std::ofstream &file, const char* destReg, Context *context) const override    {
             if(context->LoopStartPoint!="") {
-                file<<"addiu $sp, $sp, "<<(context->stack.size - context->LoopInitSP)<<std::endl;
                 file<<"b "<<context->LoopStartPoint<<std::endl;
                 file<<"nop"<<std::endl;
             }
@@ -0,0 +1,84 @@
+#ifndef COMPILER_AST_MAGIC_NUMBERS_HPP
+#define COMPILER_AST_MAGIC_NUMBERS_HPP
+
+// multiply-high constants replacing division by a constant (Hacker's Delight, chapter 10)
+
+struct signedMagic {            // q = (mulsh(n, M) +/- n) >> shift, plus one if negative
+    int multiplier=0;
+    int shift=0;
+};
+
+struct unsignedMagic {          // q = mulhu(n, M) >> shift, or the add form if add is set
+    unsigned int multiplier=0;
+    int shift=0;
+    int add=0;
+};
+
+inline signedMagic findSignedMagic(int d) {     // 2 <= |d| < 2^31
+    const unsigned int two31 = 0x80000000;
+    signedMagic mag;
+    unsigned int ad = (d<0) ? -(unsigned int)d : d;
+    unsigned int t = two31 + ((unsigned int)d >> 31);
+    unsigned int anc = t - 1 - t%ad;            // absolute value of nc
+    int p = 31;
+    unsigned int q1 = two31/anc;
+    unsigned int r1 = two31 - q1*anc;
+    unsigned int q2 = two31/ad;
+    unsigned int r2 = two31 - q2*ad;
+    unsigned int delta;
+    do  {
+        p++;
+        q1 = 2*q1;
+        r1 = 2*r1;
+        if(r1>=anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 = 2*q2;
+        r2 = 2*r2;
+        if(r2>=ad)  {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while(q1<delta || (q1==delta && r1==0));
+    mag.multiplier = (int)(q2+1);
+    if(d<0) {
+        mag.multiplier = -mag.multiplier;
+    }
+    mag.shift = p - 32;
+    return mag;
+}
+
+inline unsignedMagic findUnsignedMagic(unsigned int d) {    // 2 <= d < 2^31
+    unsignedMagic mag;
+    int p = 31;
+    unsigned int p32 = 0;
+    unsigned int q = 0x7FFFFFFF/d;
+    unsigned int r = 0x7FFFFFFF - q*d;
+    unsigned int delta;
+    do  {
+        p++;
+        p32 = (p==32) ? 1 : 2*p32;
+        if(r+1 >= d-r)  {
+            if(q>=0x7FFFFFFF)   {
+                mag.add = 1;
+            }
+            q = 2*q + 1;
+            r = 2*r + 1 - d;
+        }
+        else    {
+            if(q>=0x80000000)   {
+                mag.add = 1;
+            }
+            q = 2*q;
+            r = 2*r + 1;
+        }
+        delta = d - 1 - r;
+    } while(p<64 && p32<delta);
+    mag.multiplier = q + 1;
+    mag.shift = p - 32;
+    return mag;
+}
+
+#endif
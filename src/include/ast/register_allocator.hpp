@@ -0,0 +1,934 @@
+#ifndef COMPILER_AST_REGISTER_ALLOCATOR_HPP
+#define COMPILER_AST_REGISTER_ALLOCATOR_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+struct liveInterval {           // live range of one local variable, in the order the prepass visits the function body
+    const void *decl=nullptr;   // declaring node (DeclareVariable or FunctionDefArgs)
+    long start=0;
+    long end=0;
+    double weight=0;            // number of uses, scaled up by loop depth (cheapest intervals get spilled first)
+    int eligible=1;             // 0 if the variable has to stay on the stack (address taken, char, FP, struct)
+    std::string hint="";        // register the value already arrives in (argument registers of leaf functions)
+    std::string reg="";
+    std::vector<long> writes;   // positions the variable is assigned at
+    std::vector<long> kills;    // positions it is overwritten without being read
+    std::vector<long> uses;
+    const void *loop=nullptr;   // loop whose preheader computes the value (hoisted loop invariants and derived pointers only)
+    std::string global="";      // global whose address is hoisted
+    int kind=0;                 // hoistEntry kind
+    std::vector<const void*> accesses;  // array accesses addressed through a derived pointer (or sharing a common value)
+    const void *until=nullptr;  // common values: last statement reading the register
+    int droppable=0;            // scalar local that needs no storage if it is never read
+    int addressTaken=0;
+    int constInit=0;            // declared with a constant initializer (initValue)
+    long initValue=0;
+};
+
+struct loopRange {
+    const void *loop=nullptr;
+    long start=0;
+    long end=0;
+    std::string counter="";     // variable a for loop steps up by one
+};
+
+struct hoistCandidate {         // loop invariant value seen by the prepass: an arithmetic expression or the address of a global
+    const void *node=nullptr;
+    std::string global="";
+    std::string key="";         // expression as written and the intervals it reads (equal keys compute the same value)
+    long reads=0;               // variables read by the expression: reads[reads, readsEnd)
+    long readsEnd=0;
+    std::vector<long> loops;    // enclosing loops, outermost first
+    double weight=0;
+    long parent=-1;             // candidate of the enclosing expression
+};
+
+struct countedLoop {            // for loop stepping a variable up by one towards a bound
+    const void *loop=nullptr;
+    long counter=-1;            // interval of the induction variable
+    long bound=-1;              // interval of the bound (-1 for a constant, -2 for anything else)
+    long start=0;               // loop range
+    long end=0;
+    long body=0;                // range of the loop body
+    long bodyEnd=0;
+    int exits=0;                // body contains break or continue
+};
+
+struct derivedCandidate {       // array access indexed by a loop counter (a[i], a[k][i] with k unchanged in the loop)
+    std::string key;            // array and index as written, equal keys share one pointer
+    const void *node=nullptr;
+    long loop=0;
+    long array=-1;              // interval of the array or pointer (-1 for globals)
+    std::vector<long> others;   // intervals of the other index variables
+    double weight=0;
+};
+
+struct commonCandidate {        // pure value computed in a run of straight-line statements (array element address or integer expression)
+    std::string key;            // expression as written and the intervals it reads, equal keys in one run share a register
+    const void *node=nullptr;
+    int access=0;               // 1 for an array element address
+    int cost=1;                 // instructions the value takes at least
+    long run=-1;
+    long statement=0;           // index of the statement in the run
+    long reads=0;               // variables read: reads[reads, readsEnd)
+    long readsEnd=0;
+    long position=0;
+    double weight=0;
+};
+
+struct straightRun {            // consecutive statements of one list without control flow between them
+    std::vector<const void*> statements;
+    std::vector<long> starts;   // position each statement's scan began at
+};
+
+struct hoistEntry {             // value computed into reg in a loop's preheader
+    static const int invariant=0;       // loop invariant expression or global address
+    static const int derived=1;         // pointer to an array element stepped along with the loop counter
+    static const int endPointer=2;      // value of the first derived pointer after the last iteration (replaces the exit test)
+    static const int commonAddress=3;   // array element address computed before a statement and reused up to until
+    static const int commonValue=4;     // integer expression computed before a statement and reused up to until
+    const void *node=nullptr;
+    std::string global="";
+    std::string reg="";
+    int kind=invariant;
+    std::vector<const void*> accesses;
+    const void *until=nullptr;
+};
+
+struct RegAllocator {
+    std::vector<liveInterval> intervals;
+    std::vector<std::unordered_map<std::string,long>> scopes;   // variable name -> index into intervals
+    std::unordered_map<const void*,std::string> assigned;       // declaring node -> register holding the variable
+    std::unordered_map<const void*,long> declared;              // declaring node -> index into intervals
+    std::vector<std::string> savedRegs;                         // callee-saved registers the function has to preserve
+    long position=0;
+    int loopDepth=0;
+    int takeAddress=0;          // set while scanning the operand of RefOperator
+    int hasCall=0;
+    int fpArgs=0;               // FP arguments may arrive in $a registers, so those cannot be handed out
+    int frameEscapes=0;         // a pointer into the frame may exist (address taken, local array or struct), so calls cannot be made after popping it
+    int writing=0;              // set while scanning the target of an assignment, ++ or -- (2 if the old value is not read)
+    long loopExits=0;           // break and continue statements seen
+    std::vector<loopRange> loops;
+    std::vector<long> openLoops;                                // loops enclosing the current position, outermost first
+    std::vector<long> reads;                                    // interval read by each use (-1 for globals)
+    std::vector<hoistCandidate> candidates;
+    std::unordered_map<const void*,std::vector<hoistEntry>> hoists;    // loop -> loop invariant values computed before it (function body -> global addresses computed after the prologue, statement -> common values of its run)
+    const void *body=nullptr;   // function body being allocated
+    std::vector<countedLoop> counted;
+    std::unordered_map<const void*,int> countedFlags;          // loop -> counterStepped | boundFixed | noExits
+    std::vector<derivedCandidate> derivedUses;
+    std::vector<commonCandidate> commonUses;
+    std::vector<straightRun> runs;
+    std::vector<long> openRuns;                                 // per statement list being scanned: run its next straight-line statement joins (-1 for none)
+    std::vector<std::pair<long,long>> scanning;                 // per statement being scanned: its run (-1 for none) and index in the run
+    std::vector<std::pair<long,long>> hoistedReads;             // reads of the loop invariant expressions computed before their loop
+    std::unordered_map<const void*,long> knownConds;           // if statement -> value its condition folds to (only the taken branch was scanned)
+    std::unordered_map<const void*,int> unread;                // declaring node -> 1 if the variable is written but never read
+    std::unordered_map<const void*,long> constants;            // declaring node -> value of a local only ever assigned its constant initializer (found by the previous scan)
+    static const int counterStepped=1;  // only the increment writes the counter
+    static const int boundFixed=2;      // nothing in the loop writes the bound
+    static const int noExits=4;         // no break or continue in the body
+    static const int counterDead=8;     // the counter is only read by the exit test and derived accesses, and is dead after the loop
+    static const int constantRounds=4;  // prepass scans spent looking for more constant locals
+
+    void reset()    {
+        intervals.clear();
+        scopes.clear();
+        assigned.clear();
+        declared.clear();
+        savedRegs.clear();
+        position=0;
+        loopDepth=0;
+        takeAddress=0;
+        hasCall=0;
+        fpArgs=0;
+        frameEscapes=0;
+        writing=0;
+        loopExits=0;
+        loops.clear();
+        openLoops.clear();
+        reads.clear();
+        candidates.clear();
+        hoists.clear();
+        counted.clear();
+        countedFlags.clear();
+        derivedUses.clear();
+        commonUses.clear();
+        runs.clear();
+        openRuns.clear();
+        scanning.clear();
+        hoistedReads.clear();
+        knownConds.clear();
+        unread.clear();
+        constants.clear();
+        body=nullptr;
+    }
+
+    void pushScope()    {
+        std::unordered_map<std::string,long> tmp;
+        scopes.push_back(tmp);
+    }
+
+    void popScope() {
+        scopes.pop_back();
+    }
+
+    void declare(const std::string &id, const void *decl, int eligible, std::string hint="")  {
+        if(scopes.size()==0)    {
+            pushScope();
+        }
+        std::unordered_map<const void*,long>::iterator it=declared.find(decl);
+        if(it!=declared.end())  {       // body inlined more than once: every copy shares one interval (and register)
+            liveInterval &li = intervals.at(it->second);
+            li.end = position;
+            li.eligible = li.eligible && eligible;
+            position++;
+            scopes.back()[id] = it->second;
+            return;
+        }
+        liveInterval li;
+        li.decl = decl;
+        li.start = position;
+        li.end = position;
+        li.eligible = eligible;
+        li.hint = hint;
+        intervals.push_back(li);
+        position++;
+        declared[decl] = intervals.size()-1;
+        scopes.back()[id] = intervals.size()-1;
+    }
+
+    void drop(const void *decl)    {    // variable may be removed if nothing reads it
+        std::unordered_map<const void*,long>::iterator it=declared.find(decl);
+        if(it!=declared.end())  {
+            intervals.at(it->second).droppable = 1;
+        }
+    }
+
+    void constantInit(const void *decl, long value)  {  // declaration initializes the variable to a compile time constant
+        std::unordered_map<const void*,long>::iterator it=declared.find(decl);
+        if(it!=declared.end())  {
+            intervals.at(it->second).constInit = 1;
+            intervals.at(it->second).initValue = value;
+        }
+    }
+
+    std::unordered_map<const void*,long> constantLocals() const {   // locals never assigned after their constant initializer and never addressed
+        std::unordered_map<const void*,long> found;
+        for(long i=0;i<intervals.size();i++)    {
+            const liveInterval &li = intervals.at(i);
+            if(li.constInit==1 && li.writes.size()==0 && li.addressTaken==0)  {
+                found[li.decl] = li.initValue;
+            }
+        }
+        return found;
+    }
+
+    int constantOf(const std::string &id, long &value) const   {   // returns 1 if the local in scope was found to hold a constant
+        long index = lookup(id);
+        if(index<0) {
+            return 0;
+        }
+        std::unordered_map<const void*,long>::const_iterator it=constants.find(intervals.at(index).decl);
+        if(it==constants.end()) {
+            return 0;
+        }
+        value = it->second;
+        return 1;
+    }
+
+    void liveFrom(const std::string &id, long start)    {   // variable is written before its declaration point (parameters of an inlined call)
+        liveInterval &li = intervals.at(scopes.back().at(id));
+        if(start < li.start)    {
+            li.start = start;
+        }
+    }
+
+    double loopWeight() const   {
+        double w=1;
+        for(int d=0;d<loopDepth && d<6;d++) {
+            w*=8;
+        }
+        return w;
+    }
+
+    int isLocal(const std::string &id) const    {
+        for(long i=scopes.size()-1;i>=0;i--)    {
+            if(scopes.at(i).find(id)!=scopes.at(i).end())  {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    long lookup(const std::string &id) const   {   // interval of a local variable, -1 for globals
+        for(long i=scopes.size()-1;i>=0;i--)    {
+            std::unordered_map<std::string,long>::const_iterator it=scopes.at(i).find(id);
+            if(it!=scopes.at(i).end())  {
+                return it->second;
+            }
+        }
+        return -1;
+    }
+
+    void use(const std::string &id) {   // reads and writes are treated alike for liveness
+        long index=-1;
+        for(long i=scopes.size()-1;i>=0;i--)    {
+            std::unordered_map<std::string,long>::iterator it=scopes.at(i).find(id);
+            if(it!=scopes.at(i).end())  {
+                index = it->second;
+                liveInterval &li = intervals.at(index);
+                li.weight+=loopWeight();
+                li.end=position;
+                if(takeAddress==1)  {
+                    li.eligible=0;
+                    li.addressTaken=1;
+                    frameEscapes=1;
+                }
+                li.uses.push_back(position);
+                if(writing!=0)  {
+                    li.writes.push_back(position);
+                }
+                if(writing==2)  {
+                    li.kills.push_back(position);
+                }
+                break;
+            }
+        }                               // not found: global variable, never allocated
+        reads.push_back(index);
+        position++;
+    }
+
+    void candidate(const void *node, long readMark, long candidateMark, const std::string &key)  {  // expression over reads[readMark..] that may be loop invariant
+        if(openLoops.size()==0) {
+            return;
+        }
+        hoistCandidate c;
+        c.node = node;
+        std::stringstream text;
+        text<<key;
+        for(long r=readMark;r<reads.size();r++) {
+            text<<"|"<<reads.at(r);
+        }
+        c.key = text.str();
+        c.reads = readMark;
+        c.readsEnd = reads.size();
+        c.loops = openLoops;
+        c.weight = loopWeight();
+        for(long i=candidateMark;i<candidates.size();i++)   {
+            if(candidates.at(i).parent==-1) {
+                candidates.at(i).parent = candidates.size();
+            }
+        }
+        candidates.push_back(c);
+    }
+
+    void globalUse(const std::string &id)   {   // the address of a global never changes
+        hoistCandidate c;
+        c.global = id;
+        c.loops = openLoops;
+        c.weight = loopWeight();
+        candidates.push_back(c);
+    }
+
+    std::string innerCounter() const    {   // counter of the innermost loop ("" if it is not a counted for loop)
+        return (openLoops.size()>0) ? loops.at(openLoops.back()).counter : "";
+    }
+
+    void inductionUse(const std::string &key, const void *node, const std::string &array, const std::vector<std::string> &others)  {
+        derivedCandidate c;
+        c.key = key;
+        c.node = node;
+        c.loop = openLoops.back();
+        c.array = lookup(array);
+        for(long i=0;i<others.size();i++)   {
+            long index = lookup(others.at(i));
+            if(index<0) {
+                return;                 // globals may change inside the loop
+            }
+            c.others.push_back(index);
+        }
+        c.weight = loopWeight();
+        derivedUses.push_back(c);
+    }
+
+    void statementStart(const void *node, int straight)  {  // straight-line statements of a list form runs, anything else ends the run
+        long level = scanning.size();
+        if(openRuns.size()<=level)  {
+            openRuns.resize(level+1, -1);
+        }
+        long run=-1;
+        long index=-1;
+        if(straight==1) {
+            if(openRuns.at(level)==-1)  {
+                runs.push_back(straightRun());
+                openRuns.at(level) = runs.size()-1;
+            }
+            run = openRuns.at(level);
+            runs.at(run).statements.push_back(node);
+            runs.at(run).starts.push_back(position);
+            index = runs.at(run).statements.size()-1;
+        }
+        else    {
+            openRuns.at(level) = -1;
+        }
+        scanning.push_back(std::make_pair(run, index));
+    }
+
+    void statementEnd(int last) {
+        scanning.pop_back();
+        if(last==1) {
+            openRuns.at(scanning.size()) = -1;
+        }
+    }
+
+    void commonUse(const std::string &key, const void *node, int access, int cost, long readMark)  {   // pure value over reads[readMark..] that may be computed once for its run
+        if(scanning.size()==0 || scanning.back().first==-1 || readMark==reads.size()) {
+            return;
+        }
+        commonCandidate c;
+        c.node = node;
+        c.access = access;
+        c.cost = cost;
+        c.run = scanning.back().first;
+        c.statement = scanning.back().second;
+        c.reads = readMark;
+        c.readsEnd = reads.size();
+        c.position = position-1;       // last read
+        c.weight = loopWeight();
+        std::stringstream text;
+        text<<key;
+        for(long r=readMark;r<reads.size();r++) {
+            if(reads.at(r)<0)   {
+                return;                 // globals may change through calls and pointers
+            }
+            text<<"|"<<reads.at(r);
+        }
+        c.key = text.str();
+        commonUses.push_back(c);
+    }
+
+    long loopStart(const void *loop)    {
+        loopRange range;
+        range.loop = loop;
+        range.start = position;
+        loops.push_back(range);
+        openLoops.push_back(loops.size()-1);
+        loopDepth++;
+        return position;
+    }
+
+    void loopEnd(long start)    {       // values live around the back edge stay live for the whole loop
+        loops.at(openLoops.back()).end = position;
+        openLoops.pop_back();
+        loopDepth--;
+        for(long i=0;i<intervals.size();i++)    {
+            liveInterval &li = intervals.at(i);
+            if(li.start<start && li.end>=start) {
+                li.end = position;
+            }
+        }
+        position++;
+    }
+
+    int invariantIn(const hoistCandidate &c, const loopRange &range) const  {   // no variable read by the candidate is declared or assigned inside the loop
+        for(long r=c.reads;r<c.readsEnd;r++)    {
+            if(reads.at(r)<0)   {
+                return 0;               // globals may change through calls and pointers
+            }
+            const liveInterval &li = intervals.at(reads.at(r));
+            if(li.eligible==0 || li.start>=range.start) {
+                return 0;               // address taken, or (re)declared every iteration
+            }
+            for(long w=0;w<li.writes.size();w++)    {
+                if(li.writes.at(w)>=range.start && li.writes.at(w)<=range.end)  {
+                    return 0;
+                }
+            }
+        }
+        return 1;
+    }
+
+    int writtenIn(long index, long start, long end) const   {
+        const liveInterval &li = intervals.at(index);
+        for(long w=0;w<li.writes.size();w++)    {
+            if(li.writes.at(w)>=start && li.writes.at(w)<=end)  {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    int killedAt(const liveInterval &li, long from) const   {   // the first use from position on overwrites the variable (or there is none)
+        for(long u=0;u<li.uses.size();u++)  {
+            if(li.uses.at(u)>=from) {
+                return (std::find(li.kills.begin(), li.kills.end(), li.uses.at(u))!=li.kills.end()) ? 1 : 0;
+            }
+        }
+        return 1;
+    }
+
+    int deadAfter(long index, const countedLoop &cl) const  {   // value left in the counter is never read
+        const liveInterval &li = intervals.at(index);
+        if(killedAt(li, cl.end+1)==0)   {
+            return 0;
+        }
+        for(long l=0;l<loops.size();l++)    {   // enclosing loops carry it around their back edge
+            const loopRange &range = loops.at(l);
+            if(range.start<cl.start && range.end>cl.end && li.start<range.start && killedAt(li, range.start)==0) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    int usesIn(long index, long start, long end) const  {
+        const liveInterval &li = intervals.at(index);
+        int count=0;
+        for(long u=0;u<li.uses.size();u++)  {
+            if(li.uses.at(u)>=start && li.uses.at(u)<=end)  {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    int invariantVar(long index, long start, long end) const    {  // local declared before the range and not written inside it
+        const liveInterval &li = intervals.at(index);
+        return (li.eligible==1 && li.start<start && writtenIn(index, start, end)==0) ? 1 : 0;
+    }
+
+    void countLoops()   {   // what stays fixed in each counted for loop (unrolling, derived pointers)
+        for(long c=0;c<counted.size();c++)  {
+            const countedLoop &cl = counted.at(c);
+            int flags = (cl.exits==0) ? noExits : 0;
+            if(intervals.at(cl.counter).eligible==1 && writtenIn(cl.counter, cl.body, cl.bodyEnd-1)==0)    {
+                flags |= counterStepped;
+            }
+            if(cl.bound==-1 || (cl.bound>=0 && invariantVar(cl.bound, cl.start, cl.end)==1))   {
+                flags |= boundFixed;
+            }
+            int derived=0;
+            for(long d=0;d<derivedUses.size();d++)  {
+                if(loops.at(derivedUses.at(d).loop).start==cl.start)   {
+                    derived++;
+                }
+            }
+            if(derived>0 && usesIn(cl.counter, cl.body, cl.bodyEnd-1)==derived && deadAfter(cl.counter, cl)==1)  {
+                flags |= counterDead;
+            }
+            std::unordered_map<const void*,int>::iterator it=countedFlags.find(cl.loop);
+            countedFlags[cl.loop] = (it==countedFlags.end()) ? flags : (it->second & flags);  // every inlined copy has to qualify
+        }
+    }
+
+    void derive()   {   // give each array access indexed by a counter a pointer covering its loop
+        std::map<std::pair<std::string,const void*>,long> byKey;
+        std::unordered_map<const void*,long> ends;
+        std::unordered_map<const void*,int> complete;   // loop -> 1 while every access indexed by its counter gets a pointer
+        std::unordered_map<const void*,double> iteration;  // loop -> weight of one use per iteration
+        for(long d=0;d<derivedUses.size();d++)  {
+            const derivedCandidate &c = derivedUses.at(d);
+            const loopRange &range = loops.at(c.loop);
+            std::unordered_map<const void*,int>::iterator flags = countedFlags.find(range.loop);
+            int ok = (flags!=countedFlags.end() && (flags->second & counterStepped)!=0) ? 1 : 0;
+            if(c.array>=0 && invariantVar(c.array, range.start, range.end)==0)  {
+                ok=0;
+            }
+            for(long o=0;o<c.others.size();o++) {
+                if(invariantVar(c.others.at(o), range.start, range.end)==0) {
+                    ok=0;
+                }
+            }
+            std::unordered_map<const void*,int>::iterator it=complete.find(range.loop);
+            complete[range.loop] = (it==complete.end()) ? ok : (it->second && ok);
+            iteration[range.loop] = std::max(iteration[range.loop], c.weight);
+            if(ok==0)   {
+                continue;
+            }
+            std::map<std::pair<std::string,const void*>,long>::iterator kt=byKey.find(std::make_pair(c.key, range.loop));
+            long index = (kt!=byKey.end()) ? kt->second : -1;
+            if(index==-1)   {
+                liveInterval li;
+                li.decl = c.node;
+                li.loop = range.loop;
+                li.kind = hoistEntry::derived;
+                li.start = range.start;
+                li.end = range.end;
+                intervals.push_back(li);
+                index = intervals.size()-1;
+                byKey[std::make_pair(c.key, range.loop)] = index;
+            }
+            liveInterval &li = intervals.at(index);
+            li.start = std::min(li.start, range.start);
+            li.end = std::max(li.end, range.end);
+            li.weight += c.weight;
+            if(std::find(li.accesses.begin(), li.accesses.end(), c.node)==li.accesses.end())  {
+                li.accesses.push_back(c.node);
+            }
+        }
+        for(long c=0;c<counted.size();c++)  {      // end pointer for loops whose counter only feeds the exit test
+            const countedLoop &cl = counted.at(c);
+            std::unordered_map<const void*,int>::iterator it=complete.find(cl.loop);
+            if(it==complete.end() || it->second==0 || (countedFlags[cl.loop] & (counterDead|boundFixed))!=(counterDead|boundFixed))   {
+                continue;
+            }
+            std::unordered_map<const void*,long>::iterator et=ends.find(cl.loop);
+            if(et==ends.end())  {
+                liveInterval li;
+                li.decl = cl.loop;
+                li.loop = cl.loop;
+                li.kind = hoistEntry::endPointer;
+                li.start = cl.start;
+                li.end = cl.end;
+                intervals.push_back(li);
+                ends[cl.loop] = intervals.size()-1;
+                et = ends.find(cl.loop);
+            }
+            liveInterval &li = intervals.at(et->second);
+            li.start = std::min(li.start, cl.start);
+            li.end = std::max(li.end, cl.end);
+            li.weight += iteration[cl.loop];
+        }
+    }
+
+    void hoist()    {   // give each loop invariant an interval covering the outermost loop it is invariant in
+        std::vector<int> hoisted(candidates.size(), 0);
+        std::unordered_map<const void*,long> byNode;
+        std::map<std::pair<std::string,const void*>,long> byGlobal;
+        std::map<std::pair<std::string,const void*>,long> byValue;     // equal expressions invariant in the same loop share one register
+        std::map<std::string,long> outside;             // global -> accesses outside any loop
+        for(long c=0;c<candidates.size();c++)   {
+            if(candidates.at(c).global!="" && candidates.at(c).loops.size()==0)  {
+                outside[candidates.at(c).global]++;
+            }
+        }
+        for(long c=candidates.size()-1;c>=0;c--)    {   // enclosing expressions come first, their operands are not hoisted separately
+            const hoistCandidate &cand = candidates.at(c);
+            if(cand.parent!=-1 && hoisted.at(cand.parent)==1)  {
+                hoisted.at(c)=1;
+                continue;
+            }
+            if(cand.global!="" && body!=nullptr && outside[cand.global]>=2)  {  // used repeatedly across the body: one address for the whole function
+                hoisted.at(c)=1;
+                std::map<std::pair<std::string,const void*>,long>::iterator it=byGlobal.find(std::make_pair(cand.global, body));
+                if(it==byGlobal.end())  {
+                    liveInterval li;
+                    li.global = cand.global;
+                    li.loop = body;
+                    li.start = 0;
+                    li.end = position;
+                    intervals.push_back(li);
+                    it = byGlobal.insert(std::make_pair(std::make_pair(cand.global, body), (long)(intervals.size()-1))).first;
+                }
+                intervals.at(it->second).weight += cand.weight;
+                continue;
+            }
+            const loopRange *range = nullptr;
+            for(long l=0;l<cand.loops.size() && range==nullptr;l++) {
+                if(invariantIn(cand, loops.at(cand.loops.at(l)))==1)  {
+                    range = &loops.at(cand.loops.at(l));
+                }
+            }
+            if(range==nullptr)  {
+                continue;
+            }
+            hoisted.at(c)=1;
+            long index=-1;
+            if(cand.global!="") {
+                std::map<std::pair<std::string,const void*>,long>::iterator it=byGlobal.find(std::make_pair(cand.global, range->loop));
+                index = (it!=byGlobal.end()) ? it->second : -1;
+            }
+            else    {
+                std::unordered_map<const void*,long>::iterator it=byNode.find(cand.node);
+                if(it!=byNode.end() && intervals.at(it->second).loop!=range->loop)  {
+                    continue;           // copy of an inlined body invariant in a different loop
+                }
+                index = (it!=byNode.end()) ? it->second : -1;
+                if(index==-1)   {
+                    std::map<std::pair<std::string,const void*>,long>::iterator vt=byValue.find(std::make_pair(cand.key, range->loop));
+                    index = (vt!=byValue.end()) ? vt->second : -1;
+                }
+            }
+            if(index==-1)   {
+                liveInterval li;
+                li.decl = cand.node;
+                li.global = cand.global;
+                li.loop = range->loop;
+                li.start = range->start;
+                li.end = range->end;
+                intervals.push_back(li);
+                index = intervals.size()-1;
+                if(cand.global!="") {
+                    byGlobal[std::make_pair(cand.global, range->loop)] = index;
+                }
+                else    {
+                    byValue[std::make_pair(cand.key, range->loop)] = index;
+                }
+            }
+            if(cand.global=="") {
+                byNode[cand.node] = index;
+            }
+            liveInterval &li = intervals.at(index);     // same loop reached again through another inlined copy, or the same value again
+            if(cand.global=="" && std::find(li.accesses.begin(), li.accesses.end(), cand.node)==li.accesses.end())  {
+                li.accesses.push_back(cand.node);
+            }
+            li.start = std::min(li.start, range->start);
+            li.end = std::max(li.end, range->end);
+            li.weight += cand.weight;
+            if(cand.global=="") {
+                hoistedReads.push_back(std::make_pair(cand.reads, cand.readsEnd));
+            }
+        }
+    }
+
+    void common()   {   // give values computed more than once in a run one register from the start of the statement first computing them
+        std::unordered_map<const void*,int> taken;     // nodes already computed before their loop or walked by a derived pointer
+        for(long i=0;i<intervals.size();i++)    {
+            const liveInterval &li = intervals.at(i);
+            if(li.kind==hoistEntry::derived || (li.kind==hoistEntry::invariant && li.loop!=nullptr && li.global==""))   {
+                for(long a=0;a<li.accesses.size();a++)  {
+                    taken[li.accesses.at(a)] = 1;
+                }
+            }
+        }
+        std::map<std::pair<long,std::string>,std::vector<long>> groups;
+        for(long c=0;c<commonUses.size();c++)   {
+            if(taken.find(commonUses.at(c).node)==taken.end())   {
+                groups[std::make_pair(commonUses.at(c).run, commonUses.at(c).key)].push_back(c);
+            }
+        }
+        std::vector<const std::vector<long>*> order;
+        for(std::map<std::pair<long,std::string>,std::vector<long>>::iterator it=groups.begin();it!=groups.end();it++)   {
+            if(it->second.size()>=2)    {
+                order.push_back(&it->second);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [this](const std::vector<long> *a, const std::vector<long> *b) {  // enclosing expressions first
+            const commonCandidate &ca = commonUses.at(a->at(0));
+            const commonCandidate &cb = commonUses.at(b->at(0));
+            return (ca.readsEnd-ca.reads) > (cb.readsEnd-cb.reads);
+        });
+        std::vector<std::pair<long,long>> covered = hoistedReads;   // reads of values no longer computed where they are written
+        for(long g=0;g<order.size();g++)    {
+            const std::vector<long> &group = *order.at(g);
+            std::vector<long> live;
+            for(long m=0;m<group.size();m++)    {
+                const commonCandidate &c = commonUses.at(group.at(m));
+                int inside=0;
+                for(long v=0;v<covered.size() && inside==0;v++) {
+                    if(c.reads>=covered.at(v).first && c.readsEnd<=covered.at(v).second)    {
+                        inside=1;
+                    }
+                }
+                if(inside==0)   {
+                    live.push_back(group.at(m));
+                }
+            }
+            if(live.size()<2 || (live.size()-1)*commonUses.at(live.at(0)).cost<2)   {    // a register for a single instruction saved is not worth it
+                continue;
+            }
+            const commonCandidate &first = commonUses.at(live.at(0));
+            const straightRun &run = runs.at(first.run);
+            long statement = first.statement;
+            long last = first.statement;
+            long end = first.position;
+            double weight = 0;
+            for(long m=0;m<live.size();m++) {
+                const commonCandidate &c = commonUses.at(live.at(m));
+                statement = std::min(statement, c.statement);
+                last = std::max(last, c.statement);
+                end = std::max(end, c.position);
+                weight += c.weight;
+            }
+            long start = run.starts.at(statement);
+            int ok=1;
+            for(long r=first.reads;r<first.readsEnd && ok==1;r++) {
+                const liveInterval &li = intervals.at(reads.at(r));
+                if(li.addressTaken==1 || li.start>=start || writtenIn(reads.at(r), start, end)==1)  {
+                    ok=0;               // may change between the statements, or not declared yet
+                }
+            }
+            if(ok==0)   {
+                continue;
+            }
+            liveInterval li;
+            li.decl = first.node;
+            li.loop = run.statements.at(statement);
+            li.until = run.statements.at(last);
+            li.kind = (first.access==1) ? hoistEntry::commonAddress : hoistEntry::commonValue;
+            li.start = start;
+            li.end = end;
+            li.weight = weight - first.weight;      // the first computation remains
+            for(long m=0;m<live.size();m++) {
+                const commonCandidate &c = commonUses.at(live.at(m));
+                if(std::find(li.accesses.begin(), li.accesses.end(), c.node)==li.accesses.end())  {
+                    li.accesses.push_back(c.node);
+                }
+                covered.push_back(std::make_pair(c.reads, c.readsEnd));
+            }
+            intervals.push_back(li);
+        }
+    }
+
+    void allocate() {
+        countLoops();
+        derive();
+        hoist();
+        common();
+        for(long i=0;i<intervals.size();i++)    {  // locals that are only ever overwritten get neither a register nor a stack slot
+            liveInterval &li = intervals.at(i);
+            if(li.droppable==1 && li.uses.size()==li.kills.size())  {
+                li.eligible=0;
+                unread[li.decl]=1;
+            }
+        }
+        std::vector<std::string> pool;
+        if(hasCall==0 && fpArgs==0)  {         // leaf function: argument registers are free after the prologue
+            for(int i=0;i<4;i++)    {
+                pool.push_back("$a"+std::to_string(i));
+            }
+        }
+        for(int i=0;i<8;i++)    {
+            pool.push_back("$s"+std::to_string(i));
+        }
+        std::vector<long> order;
+        for(long i=0;i<intervals.size();i++)    {
+            if(intervals.at(i).eligible==1) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [this](long a, long b) {
+            return intervals.at(a).start < intervals.at(b).start;
+        });
+        std::vector<long> active;
+        for(long n=0;n<order.size();n++)    {
+            liveInterval &cur = intervals.at(order.at(n));
+            for(long i=active.size()-1;i>=0;i--)    {   // expire intervals that ended before this one starts
+                if(intervals.at(active.at(i)).end < cur.start)  {
+                    active.erase(active.begin()+i);
+                }
+            }
+            std::string reg="";
+            std::vector<std::string> candidates;
+            if(cur.hint!="" && hasCall==0)  {
+                candidates.push_back(cur.hint);
+            }
+            candidates.insert(candidates.end(), pool.begin(), pool.end());
+            for(long c=0;c<candidates.size() && reg=="";c++)  {
+                int busy=0;
+                for(long i=0;i<active.size();i++)   {
+                    if(intervals.at(active.at(i)).reg==candidates.at(c))  {
+                        busy=1;
+                    }
+                }
+                if(candidates.at(c).substr(0,2)=="$s" && cur.weight<=2)    {  // not worth the save and restore
+                    busy=1;
+                }
+                if(busy==0) {
+                    reg=candidates.at(c);
+                }
+            }
+            if(reg=="") {                               // out of registers: spill whichever is used least
+                long victim=0;
+                for(long i=1;i<active.size();i++)   {
+                    if(intervals.at(active.at(i)).weight < intervals.at(active.at(victim)).weight)  {
+                        victim=i;
+                    }
+                }
+                if(active.size()==0 || intervals.at(active.at(victim)).weight >= cur.weight)   {
+                    continue;                           // current interval stays on the stack
+                }
+                reg = intervals.at(active.at(victim)).reg;
+                intervals.at(active.at(victim)).reg="";
+                active.erase(active.begin()+victim);
+            }
+            cur.reg=reg;
+            active.push_back(order.at(n));
+        }
+        std::unordered_map<const void*,int> spilled;   // loop -> 1 if one of its derived pointers stays unallocated
+        for(long i=0;i<intervals.size();i++)    {
+            if(intervals.at(i).kind==hoistEntry::derived && intervals.at(i).reg=="") {
+                spilled[intervals.at(i).loop] = 1;
+            }
+        }
+        for(long i=0;i<intervals.size();i++)    {
+            liveInterval &li = intervals.at(i);
+            if(li.kind==hoistEntry::endPointer && spilled.find(li.loop)!=spilled.end())    {
+                li.reg="";                              // counter still needed for the exit test
+            }
+            if(li.reg!="")  {
+                if(li.loop!=nullptr)    {
+                    hoistEntry entry;
+                    entry.node = li.decl;
+                    entry.global = li.global;
+                    entry.reg = li.reg;
+                    entry.kind = li.kind;
+                    entry.accesses = li.accesses;
+                    entry.until = li.until;
+                    hoists[li.loop].push_back(entry);
+                }
+                else    {
+                    assigned[li.decl]=li.reg;
+                }
+                if(li.reg.substr(0,2)=="$s" && std::find(savedRegs.begin(),savedRegs.end(),li.reg)==savedRegs.end()) {
+                    savedRegs.push_back(li.reg);
+                }
+            }
+        }
+        std::sort(savedRegs.begin(), savedRegs.end());
+    }
+
+    int isUnread(const void *decl) const  {
+        return (unread.find(decl)!=unread.end()) ? 1 : 0;
+    }
+
+    int knownCondition(const void *node, long &value) const  {    // returns 1 if the prepass folded the node's condition
+        std::unordered_map<const void*,long>::const_iterator it=knownConds.find(node);
+        if(it==knownConds.end())    {
+            return 0;
+        }
+        value = it->second;
+        return 1;
+    }
+
+    std::string regFor(const void *decl) const  {
+        std::unordered_map<const void*,std::string>::const_iterator it=assigned.find(decl);
+        if(it==assigned.end())  {
+            return "";
+        }
+        return it->second;
+    }
+};
+
+struct ExprRegStack {           // register stack for evaluating integer expression trees (Sethi-Ullman order)
+    static const int opaque=1000;   // need of nodes that use fixed scratch registers, they are only evaluated at the bottom of the stack
+    int depth=0;                    // registers below depth hold live operands
+    std::vector<std::string> pool={"$t1","$t2","$t3","$t4","$t5","$t6","$t7"};    // $t0, $t8 and $t9 stay free for fixed scratch use ($t8 also holds constant factors)
+
+    std::string top() const {
+        return pool.at(depth);
+    }
+
+    int available() const   {
+        return pool.size()-depth;
+    }
+
+    static int combine(int a, int b)    {   // registers needed by a binary node with children needing a and b
+        if(a>=opaque || b>=opaque)  {
+            return opaque;
+        }
+        if(a==b)    {
+            return a+1;
+        }
+        return std::max(std::max(a,b),1);
+    }
+};
+
+#endif
@@ -8,8 +8,11 @@
 #include <list>
 #include <iterator>
 #include <sstream>
+#include "register_allocator.hpp"
+#include "magic_numbers.hpp"
 
 std::string makeLabel(const char* _name);
+class FunctionDef;
 
 struct varInfo {
     long offset;
@@ -25,6 +28,10 @@ struct varInfo {
     std::string FP_label;
     std::string FP_value;
     std::string type="";
+    std::string reg="";     // register holding the variable (empty if it lives on the stack)
+    int dead=0;             // never read, stores to it are dropped
+    int isSmall=0;          // global placed in .sdata/.sbss, reached from $gp in one instruction
+    int isConst=0;          // local only ever holding initValue, reads fold to it
     std::vector<long> dimension;
     std::vector<long> blockSize;
 };
@@ -33,6 +40,9 @@ struct functionInfo {
     int argCount=0;
     std::string returnType="";
     std::vector<varInfo> argList;
+    const FunctionDef *def=nullptr;     // definition already generated (candidate for inlining)
+    long size=-1;                       // instructions in the generated body
+    int hasCall=1;                      // body still makes calls after inlining
 };
 
 struct typeInfo {
@@ -49,15 +59,89 @@ struct structInfo {
     std::unordered_map<std::string,varInfo> structElements;
 };
 
+struct StackSlider {             // next free byte of the current frame, remembers the furthest it reached
+    long value=0;
+    long peak=0;
+
+    operator long() const   {
+        return value;
+    }
+
+    StackSlider &operator=(long _value)  {
+        value = _value;
+        if(value>peak)  {
+            peak = value;
+        }
+        return *this;
+    }
+
+    StackSlider &operator+=(long delta)  {
+        return *this = value+delta;
+    }
+
+    StackSlider &operator-=(long delta)  {
+        value -= delta;
+        return *this;
+    }
+};
+
+struct FrameMark {              // usage of the enclosing frame while a function's is open
+    long base=0;
+    long peak=0;
+    long callArea=0;
+};
+
 struct VarLUT {
     long size=0;
-    long slider=0;
+    StackSlider slider;
     long FP=0;
+    long callArea=0;            // outgoing argument area the calls made from the current function need at the bottom of its frame
+    int grown=0;                // a frame used more than was allocated for it (the function body is generated again)
+    std::unordered_map<const void*,long> frames;    // function body -> bytes its nested scopes, temporaries and calls need at once, measured by generating it
     std::vector<std::unordered_map<std::string,varInfo>> lut;
+
+    long frameSize(const void *node, long estimate) const  {   // bytes to allocate, the spaceRequired estimate until the frame has been measured
+        std::unordered_map<const void*,long>::const_iterator it=frames.find(node);
+        return (it==frames.end()) ? estimate : it->second;
+    }
+
+    FrameMark openFrame(long base)  {   // moves the slider to the base of a function's frame
+        FrameMark mark;
+        mark.base = base;
+        mark.peak = slider.peak;
+        mark.callArea = callArea;
+        slider.value = base;
+        slider.peak = base;
+        callArea = 0;
+        return mark;
+    }
+
+    void closeFrame(const void *node, long allocated, const FrameMark &mark)  {   // records the locals, temporaries and argument area the frame held at once
+        long used = slider.peak - mark.base;
+        if(callArea>0)  {
+            used += callArea;
+            if(used%8)  {
+                used += 8-(used%8);
+            }
+        }
+        if(node!=nullptr)   {
+            long &size = frames[node];
+            if(used>size)   {
+                size = used;
+            }
+            if(used>allocated)  {
+                grown = 1;
+            }
+        }
+        slider.peak = mark.peak;
+        callArea = mark.callArea;
+    }
 };
 
 struct Context {
     VarLUT stack;
+    RegAllocator regs;
+    ExprRegStack exprRegs;
     std::unordered_map<std::string,functionInfo> ftable;
     std::unordered_map<std::string,functionInfo>::iterator ftEntry;
     std::unordered_map<std::string,typeInfo> typeTable;
@@ -67,16 +151,31 @@ struct Context {
     std::string LoopEndPoint="";
     std::string BranchEndPoint="";
     std::string FuncRetnPoint="";
+    std::string FuncEntryPoint="";          // after the prologue's register saves (self tail calls loop back here)
+    std::vector<std::string> FrameRegs;     // registers saved by the prologue, at 4+4*i above the locals
+    long FrameSize=0;                       // bytes of the frame holding the saved registers
+    std::unordered_map<const void*,int> inlineSites;    // call site -> 1 if the callee is expanded in place (decided by the register prepass)
+    std::vector<std::string> inlineStack;               // current function and the callees being expanded into it
+    const void *returnedCall=nullptr;                   // value of the return statement being scanned (tail call candidate)
+    long inlineLimit=24;        // -finline-limit: largest callee body (in instructions) expanded at a call site
+    long inlineBudget=0;        // instructions the current function may still grow by through inlining
+    int inlineDepth=0;
+    long unrollLimit=64;        // -funroll-limit: instructions an unrolled for loop body may grow to
+    long smallData=8;           // -G: globals and FP constants of at most this many bytes go to small data
+    std::unordered_map<const void*,std::string> hoisted;        // loop invariant expression -> register it was computed into before the loop
+    std::unordered_map<std::string,std::string> globalAddr;     // global -> register holding its address inside the current loop
+    std::unordered_map<const void*,std::string> derived;        // array access -> register pointing at its element (stepped with the loop counter)
+    std::vector<hoistEntry> commonLive;                         // common values computed at the start of the current run of statements
     std::string numVal="";
     varInfo tempVarInfo;
     varInfo *vfPointer=nullptr;
     structInfo *stPointer=nullptr;
     std::list<std::string> Case_label;
     std::vector<std::pair<std::string,std::string>> strList;
+    std::vector<std::pair<std::string,std::vector<std::string>>> jumpTables;   // label : case labels, emitted to .rdata after the code
     int isFunc=0;
     int isLoop=0;
     int isSwitch=0;
-    long LoopInitSP=0;
     int ArgCount=0;
     int FPArgCount =0;
     long ArgOffset = 0;
@@ -0,0 +1,1111 @@
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+// post-passes over the generated assembly: forwards stored values to later loads, removes unreachable instructions,
+// schedules basic blocks and fills the branch delay slots (code is emitted under .set noreorder with a nop after every branch)
+
+struct asmLine {
+    std::string opcode="";
+    std::vector<std::string> operands;
+    int isLabel=0;
+    int isInstruction=0;
+};
+
+static std::string trim(const std::string &text) {
+    size_t start = text.find_first_not_of(" \t");
+    if(start==std::string::npos)    {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end-start+1);
+}
+
+static asmLine parseLine(const std::string &text)  {
+    asmLine line;
+    std::string body = trim(text);
+    if(body=="" || body.at(0)=='.' || body.at(0)=='#')  {
+        return line;
+    }
+    if(body.back()==':')    {
+        line.isLabel = 1;
+        line.opcode = body.substr(0, body.size()-1);
+        return line;
+    }
+    line.isInstruction = 1;
+    size_t space = body.find_first_of(" \t");
+    line.opcode = body.substr(0, space);
+    if(space!=std::string::npos)    {
+        std::stringstream rest(body.substr(space));
+        std::string operand;
+        while(std::getline(rest, operand, ','))  {
+            line.operands.push_back(trim(operand));
+        }
+    }
+    return line;
+}
+
+static int isBranch(const std::string &opcode)  {
+    static const char *branches[] = {"b", "j", "jal", "jr", "jalr", "beq", "bne", "blt", "bgt", "ble", "bge", "bltu", "bgtu", "bleu", "bgeu",
+                                     "beqz", "bnez", "bltz", "bgez", "blez", "bgtz", "bc1t", "bc1f"};
+    for(int i=0;i<sizeof(branches)/sizeof(branches[0]);i++) {
+        if(opcode==branches[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static std::string baseRegister(const std::string &address)  {    // register of an offset(base) operand
+    size_t open = address.rfind('(');
+    size_t close = address.rfind(')');
+    if(open==std::string::npos || close==std::string::npos || close<open)   {
+        return "";
+    }
+    return address.substr(open+1, close-open-1);
+}
+
+static int isSmallImmediate(const std::string &value)    {
+    if(value=="" || value.find_first_not_of("-0123456789")!=std::string::npos)  {
+        return 0;
+    }
+    long number = std::stol(value);
+    return (number>=-32768 && number<=65535) ? 1 : 0;
+}
+
+static int registerUse(const asmLine &line, std::vector<std::string> &reads, std::vector<std::string> &writes)  {  // returns 0 if the instruction may not be moved into a delay slot
+    static const char *threeReg[] = {"addu", "subu", "and", "or", "xor", "nor", "slt", "sltu", "sllv", "srlv", "srav"};
+    static const char *immediate[] = {"addiu", "andi", "ori", "xori", "slti", "sltiu", "sll", "srl", "sra"};
+    static const char *loads[] = {"lw", "lb", "lbu", "lh", "lhu"};
+    static const char *stores[] = {"sw", "sb", "sh"};
+    const std::vector<std::string> &ops = line.operands;
+    for(int i=0;i<sizeof(threeReg)/sizeof(threeReg[0]);i++)    {
+        if(line.opcode==threeReg[i] && ops.size()==3)   {
+            writes.push_back(ops.at(0));
+            reads.push_back(ops.at(1));
+            reads.push_back(ops.at(2));
+            return 1;
+        }
+    }
+    for(int i=0;i<sizeof(immediate)/sizeof(immediate[0]);i++)   {
+        if(line.opcode==immediate[i] && ops.size()==3)  {
+            if(ops.at(2).find('%')==std::string::npos && isSmallImmediate(ops.at(2))==0)   {
+                return 0;
+            }
+            writes.push_back(ops.at(0));
+            reads.push_back(ops.at(1));
+            return 1;
+        }
+    }
+    for(int i=0;i<sizeof(loads)/sizeof(loads[0]);i++)   {
+        if(line.opcode==loads[i] && ops.size()==2 && baseRegister(ops.at(1))!="")   {
+            writes.push_back(ops.at(0));
+            reads.push_back(baseRegister(ops.at(1)));
+            return 1;
+        }
+    }
+    for(int i=0;i<sizeof(stores)/sizeof(stores[0]);i++)  {
+        if(line.opcode==stores[i] && ops.size()==2 && baseRegister(ops.at(1))!="")  {
+            reads.push_back(ops.at(0));
+            reads.push_back(baseRegister(ops.at(1)));
+            return 1;
+        }
+    }
+    if(line.opcode=="move" && ops.size()==2)    {
+        writes.push_back(ops.at(0));
+        reads.push_back(ops.at(1));
+        return 1;
+    }
+    if((line.opcode=="li" || line.opcode=="lui") && ops.size()==2 && (isSmallImmediate(ops.at(1))==1 || ops.at(1).find('%')==0))    {
+        writes.push_back(ops.at(0));
+        return 1;
+    }
+    return 0;                                       // multi-instruction macros, HI/LO and FP instructions stay put
+}
+
+static std::vector<std::string> branchReads(const asmLine &line)  {
+    std::vector<std::string> reads;
+    if(line.opcode=="b" || line.opcode=="j" || line.opcode=="bc1t" || line.opcode=="bc1f")   {
+        return reads;
+    }
+    if(line.opcode=="jal")  {
+        reads.push_back("$ra");
+        return reads;
+    }
+    for(int i=0;i+1<line.operands.size();i++)   {   // last operand is the target label
+        reads.push_back(line.operands.at(i));
+    }
+    if(line.opcode=="jr" || line.opcode=="jalr") {
+        reads.push_back(line.operands.at(0));
+        reads.push_back("$ra");
+    }
+    return reads;
+}
+
+static int conflicts(const std::vector<std::string> &a, const std::vector<std::string> &b)  {
+    for(int i=0;i<a.size();i++) {
+        for(int j=0;j<b.size();j++) {
+            if(a.at(i)==b.at(j))    {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int isMovable(const asmLine &line, const std::vector<std::string> &branchRegs)  {
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    if(line.isInstruction==0 || registerUse(line, reads, writes)==0)    {
+        return 0;
+    }
+    if(conflicts(writes, branchRegs)==1)    {   // branch condition or return address must not change
+        return 0;
+    }
+    for(int i=0;i<reads.size();i++) {
+        if(reads.at(i)=="$ra")  {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int isJump(const asmLine &line)  {    // unconditional transfer, the code after its delay slot is only reached through a label
+    return (line.isInstruction==1 && (line.opcode=="b" || line.opcode=="j" || line.opcode=="jr")) ? 1 : 0;
+}
+
+void removeDeadCode(std::vector<std::string> &lines)    {
+    std::vector<std::string> kept;
+    std::vector<asmLine> parsed;
+    int reachable=1;
+    int slot=0;                                     // delay slot of the last jump still to come
+    for(long i=0;i<lines.size();i++)    {
+        asmLine line = parseLine(lines.at(i));
+        std::string body = trim(lines.at(i));
+        if(line.isLabel==1 || (body!="" && body.at(0)=='.'))  {
+            reachable=1;
+            slot=0;
+        }
+        if(line.isInstruction==1 && reachable==0)   {
+            continue;
+        }
+        if(line.isInstruction==1 && slot==1)    {
+            slot=0;
+            reachable=0;
+        }
+        else if(isJump(line)==1)    {
+            slot=1;
+        }
+        kept.push_back(lines.at(i));
+        parsed.push_back(line);
+    }
+    lines.clear();
+    for(long i=0;i<kept.size();i++) {              // b L; nop; L: falls through instead
+        if(i+1<kept.size() && (parsed.at(i).opcode=="b" || parsed.at(i).opcode=="j") && parsed.at(i).isInstruction==1 && parsed.at(i).operands.size()==1 && parsed.at(i+1).opcode=="nop")  {
+            long next=i+2;
+            int found=0;
+            while(next<kept.size() && parsed.at(next).isInstruction==0 && (parsed.at(next).isLabel==1 || trim(kept.at(next))==""))  {
+                if(parsed.at(next).opcode==parsed.at(i).operands.at(0)) {
+                    found=1;
+                }
+                next++;
+            }
+            if(found==1)    {
+                i++;
+                continue;
+            }
+        }
+        lines.push_back(kept.at(i));
+    }
+}
+
+void fillDelaySlots(std::vector<std::string> &lines)    {
+    std::vector<asmLine> parsed;
+    std::unordered_map<std::string,long> labels;
+    for(long i=0;i<lines.size();i++)    {
+        parsed.push_back(parseLine(lines.at(i)));
+        if(parsed.back().isLabel==1)    {
+            labels[parsed.back().opcode] = i;
+        }
+    }
+    long targetCount = 0;
+    for(long i=0;i+1<lines.size();i++)  {
+        asmLine branch = parsed.at(i);
+        if(branch.isInstruction==0 || isBranch(branch.opcode)==0 || parsed.at(i+1).opcode!="nop")   {
+            continue;
+        }
+        std::vector<std::string> branchRegs = branchReads(branch);
+        long prev = i-1;                            // instruction right before the branch (no label in between)
+        if(prev>=1 && isMovable(parsed.at(prev), branchRegs)==1 && !(parsed.at(prev-1).isInstruction==1 && isBranch(parsed.at(prev-1).opcode)==1))   {
+            lines.at(i+1) = lines.at(prev);
+            parsed.at(i+1) = parsed.at(prev);
+            lines.erase(lines.begin()+prev);
+            parsed.erase(parsed.begin()+prev);
+            for(std::unordered_map<std::string,long>::iterator it=labels.begin();it!=labels.end();it++) {
+                if(it->second>prev) {
+                    it->second--;
+                }
+            }
+            i--;
+            continue;
+        }
+        if((branch.opcode=="b" || branch.opcode=="j") && branch.operands.size()==1)  {  // copy the first instruction of the target into the slot
+            std::unordered_map<std::string,long>::iterator it = labels.find(branch.operands.at(0));
+            if(it==labels.end())    {
+                continue;
+            }
+            long target = it->second;
+            while(target<parsed.size() && parsed.at(target).isInstruction==0)    {
+                target++;
+            }
+            if(target+1>=parsed.size() || isMovable(parsed.at(target), branchRegs)==0 || isBranch(parsed.at(target-1).opcode)==1)   {
+                continue;
+            }
+            std::string label = "_ds_"+std::to_string(targetCount++)+"_";
+            lines.insert(lines.begin()+target+1, label+":");
+            parsed.insert(parsed.begin()+target+1, parseLine(label+":"));
+            for(std::unordered_map<std::string,long>::iterator jt=labels.begin();jt!=labels.end();jt++) {
+                if(jt->second>target)   {
+                    jt->second++;
+                }
+            }
+            labels[label] = target+1;
+            if(target<i)    {
+                i++;
+            }
+            lines.at(i) = branch.opcode+" "+label;
+            parsed.at(i) = parseLine(lines.at(i));
+            lines.at(i+1) = lines.at(target);
+            parsed.at(i+1) = parsed.at(target);
+        }
+    }
+}
+
+struct memoryRef {              // bytes an access reaches, by where its address came from
+    static const int frame=0;           // offset from $sp
+    static const int symbol=1;          // offset into a global
+    static const int pointer=2;         // offset from a register of unknown origin
+    int kind=pointer;
+    std::string base="";        // global name, or the register of an unknown pointer
+    long offset=0;
+    int exact=1;                // 0 if an index was added: only the object is known
+    int width=0;
+    std::string reg="";         // register holding the bytes (forwarding) or stored from (dead stores)
+    long line=-1;
+};
+
+static int slotAccess(const asmLine &line, int &isStore)  {     // bytes an lw/sw style instruction moves, 0 for anything else
+    static const char *loads[] = {"lb", "lbu", "lh", "lhu", "lw", "l.s", "lwc1", "l.d", "ldc1"};
+    static const char *stores[] = {"sb", "sb", "sh", "sh", "sw", "s.s", "swc1", "s.d", "sdc1"};
+    static const int widths[] = {1, 1, 2, 2, 4, 4, 4, 8, 8};
+    if(line.isInstruction==0 || line.operands.size()!=2 || baseRegister(line.operands.at(1))=="")   {
+        return 0;
+    }
+    for(int i=0;i<sizeof(widths)/sizeof(widths[0]);i++)    {
+        if(line.opcode==loads[i] || line.opcode==stores[i]) {
+            isStore = (line.opcode==stores[i]) ? 1 : 0;
+            return widths[i];
+        }
+    }
+    return 0;
+}
+
+static int isNumber(const std::string &text)    {
+    return (text!="" && text.find_first_not_of("-0123456789")==std::string::npos) ? 1 : 0;
+}
+
+static std::string relocated(const std::string &text, const std::string &kind)  {     // S of %kind(S), "" for anything else
+    std::string prefix = "%"+kind+"(";
+    if(text.compare(0, prefix.size(), prefix)!=0 || text.back()!=')') {
+        return "";
+    }
+    std::string name = text.substr(prefix.size(), text.size()-prefix.size()-1);
+    return (name.find_first_of("()+-")==std::string::npos) ? name : "";
+}
+
+static memoryRef resolve(const asmLine &line, const std::unordered_map<std::string,memoryRef> &points)  {  // location of a load or store
+    memoryRef ref;
+    std::string address = line.operands.at(1);
+    std::string reg = baseRegister(address);
+    std::string offset = address.substr(0, address.rfind('('));
+    int isStore=0;
+    ref.width = slotAccess(line, isStore);
+    ref.base = reg;
+    std::unordered_map<std::string,memoryRef>::const_iterator it=points.find(reg);
+    if(reg=="$gp" && relocated(offset, "gp_rel")!="")  {
+        ref.kind = memoryRef::symbol;
+        ref.base = relocated(offset, "gp_rel");
+    }
+    else if(it!=points.end() && it->second.exact==2 && relocated(offset, "lo")==it->second.base) {   // lui r, %hi(S) then %lo(S)(r)
+        ref.kind = memoryRef::symbol;
+        ref.base = it->second.base;
+    }
+    else if(reg=="$sp") {
+        ref.kind = memoryRef::frame;
+        ref.base = "";
+        ref.offset = (isNumber(offset)==1) ? std::stol(offset) : 0;
+        ref.exact = isNumber(offset);
+    }
+    else if(isNumber(offset)==0)    {
+        ref.exact = 0;
+    }
+    else if(it!=points.end() && it->second.exact!=2)    {
+        ref.kind = it->second.kind;
+        ref.base = it->second.base;
+        ref.offset = it->second.offset+std::stol(offset);
+        ref.exact = it->second.exact;
+    }
+    else    {
+        ref.offset = std::stol(offset);
+    }
+    return ref;
+}
+
+static int mustAlias(const memoryRef &a, const memoryRef &b)   {   // same bytes: a value stored to one is read back from the other
+    return (a.kind==b.kind && a.base==b.base && a.exact==1 && b.exact==1 && a.offset==b.offset && a.width==b.width) ? 1 : 0;
+}
+
+static int mayAlias(const memoryRef &a, const memoryRef &b, long escaped)  {   // escaped: lowest frame offset whose address is taken (-1 if none)
+    if(a.kind!=memoryRef::pointer && a.kind==b.kind)    {
+        if(a.base!=b.base)  {
+            return 0;               // distinct globals
+        }
+        if(a.exact==1 && b.exact==1)    {
+            return (a.offset<b.offset+b.width && b.offset<a.offset+a.width) ? 1 : 0;
+        }
+        if(a.kind==memoryRef::frame)    {   // a pointer into one frame object reaches the others above the lowest one taken
+            const memoryRef &slot = (a.exact==1) ? a : b;
+            return (slot.exact==0 || escaped<0 || slot.offset+slot.width>escaped) ? 1 : 0;
+        }
+        return 1;
+    }
+    if(a.kind!=memoryRef::pointer && b.kind!=memoryRef::pointer)   {
+        return 0;                   // the frame and the globals never overlap
+    }
+    if(a.kind==memoryRef::pointer && b.kind==memoryRef::pointer && a.base==b.base && a.exact==1 && b.exact==1)  {
+        return (a.offset<b.offset+b.width && b.offset<a.offset+a.width) ? 1 : 0;   // fields of one struct, elements of one array
+    }
+    const memoryRef &other = (a.kind==memoryRef::pointer) ? b : a;
+    if(other.kind==memoryRef::frame)    {   // only the frame objects whose address was taken are reachable
+        return (escaped>=0 && (other.exact==0 || other.offset+other.width>escaped)) ? 1 : 0;
+    }
+    return 1;
+}
+
+static int covers(const memoryRef &a, const memoryRef &b)  {   // a store to a overwrites all of b
+    return (a.kind==b.kind && a.base==b.base && a.exact==1 && b.exact==1 && b.offset>=a.offset && b.offset+b.width<=a.offset+a.width) ? 1 : 0;
+}
+
+static int sameStorage(const std::string &a, const std::string &b)  {   // FP registers pair up for doubles
+    if(a==b)    {
+        return 1;
+    }
+    if(a.size()>2 && b.size()>2 && a.compare(0, 2, "$f")==0 && b.compare(0, 2, "$f")==0
+       && a.find_first_not_of("0123456789", 2)==std::string::npos && b.find_first_not_of("0123456789", 2)==std::string::npos)  {
+        return (std::stol(a.substr(2))/2==std::stol(b.substr(2))/2) ? 1 : 0;
+    }
+    return 0;
+}
+
+static std::vector<std::string> writtenRegisters(const asmLine &line)  {   // registers the instruction may change, every named one when unknown
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    int isStore=0;
+    if(registerUse(line, reads, writes)==1) {
+        return writes;
+    }
+    if(slotAccess(line, isStore)!=0)    {
+        if(isStore==0)  {
+            writes.push_back(line.operands.at(0));
+        }
+        return writes;
+    }
+    for(int i=0;i<line.operands.size();i++) {
+        if(baseRegister(line.operands.at(i))=="")   {
+            writes.push_back(line.operands.at(i));
+        }
+    }
+    return writes;
+}
+
+static int mentions(const asmLine &line, const std::string &reg)   {
+    for(int i=0;i<line.operands.size();i++) {
+        if(sameStorage(line.operands.at(i), reg)==1 || baseRegister(line.operands.at(i))==reg)  {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static long escapedOffset(const std::vector<asmLine> &parsed, long begin, long end)  {   // lowest frame offset whose address is taken
+    long lowest = -1;
+    for(long i=begin;i<end;i++) {
+        const asmLine &line = parsed.at(i);
+        if(line.isInstruction==0 || (line.opcode=="addiu" && line.operands.size()==3 && line.operands.at(0)=="$sp" && line.operands.at(1)=="$sp")) {
+            continue;
+        }
+        for(int j=0;j<line.operands.size();j++) {
+            if(line.operands.at(j)!="$sp")  {
+                continue;
+            }
+            long offset = 0;                        // addiu r, $sp, N points at N; anything else may reach the whole frame
+            if(line.opcode=="addiu" && j==1 && line.operands.size()==3 && isSmallImmediate(line.operands.at(2))==1)    {
+                offset = std::stol(line.operands.at(2));
+            }
+            if(lowest<0 || offset<lowest)   {
+                lowest = offset;
+            }
+        }
+    }
+    return lowest;
+}
+
+static void trackAddress(const asmLine &line, std::unordered_map<std::string,memoryRef> &points)  {    // what the register an instruction writes points at
+    const std::vector<std::string> &ops = line.operands;
+    memoryRef value;
+    int known=0;
+    if(line.opcode=="lui" && ops.size()==2 && relocated(ops.at(1), "hi")!="")    {
+        value.kind = memoryRef::symbol;
+        value.base = relocated(ops.at(1), "hi");
+        value.exact = 2;            // upper half only, completed by %lo
+        known = 1;
+    }
+    else if(line.opcode=="la" && ops.size()==2 && ops.at(1).find_first_of("()$%")==std::string::npos)   {
+        value.kind = memoryRef::symbol;
+        value.base = ops.at(1);
+        known = 1;
+    }
+    else if(line.opcode=="move" && ops.size()==2 && points.count(ops.at(1))==1)    {
+        value = points.at(ops.at(1));
+        known = 1;
+    }
+    else if(line.opcode=="addiu" && ops.size()==3)  {
+        std::unordered_map<std::string,memoryRef>::iterator it=points.find(ops.at(1));
+        if(ops.at(1)=="$sp" && isNumber(ops.at(2))==1)  {
+            value.kind = memoryRef::frame;
+            value.offset = std::stol(ops.at(2));
+            known = 1;
+        }
+        else if(ops.at(1)=="$gp" && relocated(ops.at(2), "gp_rel")!="")   {
+            value.kind = memoryRef::symbol;
+            value.base = relocated(ops.at(2), "gp_rel");
+            known = 1;
+        }
+        else if(it!=points.end() && it->second.exact==2 && relocated(ops.at(2), "lo")==it->second.base)  {
+            value = it->second;
+            value.exact = 1;
+            known = 1;
+        }
+        else if(it!=points.end() && it->second.exact!=2 && isNumber(ops.at(2))==1)   {
+            value = it->second;
+            value.offset += std::stol(ops.at(2));
+            known = 1;
+        }
+    }
+    else if((line.opcode=="addu" || line.opcode=="subu") && ops.size()==3)  {     // base plus an index still points into the same object
+        std::unordered_map<std::string,memoryRef>::iterator left=points.find(ops.at(1));
+        std::unordered_map<std::string,memoryRef>::iterator right=points.find(ops.at(2));
+        if(left!=points.end() && left->second.exact!=2 && (right==points.end() || line.opcode=="subu"))   {
+            value = left->second;
+            known = 1;
+        }
+        else if(line.opcode=="addu" && right!=points.end() && right->second.exact!=2 && left==points.end())  {
+            value = right->second;
+            known = 1;
+        }
+        value.exact = 0;
+    }
+    std::vector<std::string> writes = writtenRegisters(line);
+    for(int i=0;i<writes.size();i++)    {
+        points.erase(writes.at(i));
+        if(writes.at(i)=="$sp") {
+            for(std::unordered_map<std::string,memoryRef>::iterator it=points.begin();it!=points.end();)    {
+                it = (it->second.kind==memoryRef::frame) ? points.erase(it) : std::next(it);
+            }
+        }
+    }
+    if(known==1 && writes.size()==1 && ops.size()>0 && writes.at(0)==ops.at(0)) {
+        points[ops.at(0)] = value;
+    }
+}
+
+static int samePlace(const memoryRef &a, const memoryRef &b)  {
+    return (a.kind==b.kind && a.base==b.base && a.offset==b.offset && a.exact==b.exact) ? 1 : 0;
+}
+
+static void meetPoints(std::unordered_map<std::string,memoryRef> &into, const std::unordered_map<std::string,memoryRef> &from)    {   // keeps what every path agrees on
+    for(std::unordered_map<std::string,memoryRef>::iterator it=into.begin();it!=into.end();)    {
+        std::unordered_map<std::string,memoryRef>::const_iterator other=from.find(it->first);
+        it = (other==from.end() || samePlace(it->second, other->second)==0) ? into.erase(it) : std::next(it);
+    }
+}
+
+static std::unordered_map<long,std::unordered_map<std::string,memoryRef>> pointsAtLabels(const std::vector<std::string> &lines, const std::vector<asmLine> &parsed,
+                                                                                         long begin, long end, const std::unordered_set<std::string> &escaping)  {
+    std::unordered_map<std::string,long> labels;
+    for(long i=begin;i<end;i++) {
+        if(parsed.at(i).isLabel==1) {
+            labels[parsed.at(i).opcode] = i;
+        }
+    }
+    std::unordered_map<long,std::unordered_map<std::string,memoryRef>> entry;   // label line -> registers pointing at the same place on every path into it
+    std::unordered_map<long,int> reached;
+    int changed=1;
+    while(changed==1)   {
+        changed=0;
+        std::unordered_map<std::string,memoryRef> points;
+        int live=1;                             // the fall through reaches the current line
+        int slot=0;
+        std::vector<std::pair<long,long>> jumps;    // branch line -> label line, delivered after the delay slot
+        for(long i=begin;i<end;i++) {
+            const asmLine &line = parsed.at(i);
+            std::string body = trim(lines.at(i));
+            if(line.isLabel==1) {
+                if(escaping.count(line.opcode)==1)  {   // reached from outside (calls, jump tables)
+                    points.clear();
+                    live = 1;
+                }
+                std::unordered_map<long,std::unordered_map<std::string,memoryRef>>::iterator it=entry.find(i);
+                if(live==1) {
+                    if(reached[i]==0)   {
+                        entry[i] = points;
+                        reached[i] = 1;
+                        changed = 1;
+                    }
+                    else    {
+                        size_t before = it->second.size();
+                        meetPoints(it->second, points);
+                        changed = (it->second.size()!=before) ? 1 : changed;
+                    }
+                }
+                points = entry[i];
+                live = reached[i];
+                continue;
+            }
+            if(body!="" && body.at(0)=='.') {
+                points.clear();
+                continue;
+            }
+            if(line.isInstruction==0)   {
+                continue;
+            }
+            if(line.opcode=="jal" || line.opcode=="jalr")   {
+                points.clear();
+            }
+            else    {
+                trackAddress(line, points);
+            }
+            if(slot==1) {                       // delay slot done: the branch reaches its target
+                slot = 0;
+                for(long j=0;j<jumps.size();j++)    {
+                    long target = jumps.at(j).second;
+                    if(reached[target]==0)  {
+                        entry[target] = points;
+                        reached[target] = 1;
+                        changed = 1;
+                    }
+                    else    {
+                        size_t before = entry[target].size();
+                        meetPoints(entry[target], points);
+                        changed = (entry[target].size()!=before) ? 1 : changed;
+                    }
+                }
+                jumps.clear();
+                if(isJump(parsed.at(i-1))==1)   {
+                    live = 0;
+                }
+                continue;
+            }
+            if(isBranch(line.opcode)==1 && line.opcode!="jal" && line.opcode!="jalr") {
+                slot = 1;
+                if(line.operands.size()>0 && labels.count(line.operands.back())==1)  {
+                    jumps.push_back(std::make_pair(i, labels.at(line.operands.back())));
+                }
+            }
+        }
+    }
+    return entry;
+}
+
+static std::unordered_set<std::string> escapingLabels(const std::vector<std::string> &lines, const std::vector<asmLine> &parsed)  {   // labels named by anything but a branch: calls and jump tables
+    std::unordered_set<std::string> escaping;
+    for(long i=0;i<lines.size();i++)    {
+        const asmLine &line = parsed.at(i);
+        std::string body = trim(lines.at(i));
+        if(line.isInstruction==1 && isBranch(line.opcode)==1 && line.opcode!="jal")  {
+            continue;
+        }
+        std::stringstream words(body);
+        std::string word;
+        while(words>>word)  {
+            if(word.back()==',')    {
+                word.pop_back();
+            }
+            escaping.insert(word);
+        }
+    }
+    return escaping;
+}
+
+static void forwardBlock(std::vector<std::string> &lines, std::vector<asmLine> &parsed, std::vector<int> &removed, long begin, long end, long escaped,
+                         std::unordered_map<long,std::unordered_map<std::string,memoryRef>> &entry)   {
+    std::vector<memoryRef> known;                       // locations a register still holds the value of
+    std::vector<memoryRef> pending;                     // stores nothing has read yet
+    std::unordered_map<std::string,memoryRef> points;   // register -> what it points at
+    int delaySlot=0;
+    for(long i=begin;i<end;i++) {
+        asmLine &line = parsed.at(i);
+        int inSlot = delaySlot;
+        delaySlot = (line.isInstruction==1 && isBranch(line.opcode)==1) ? 1 : 0;
+        std::string body = trim(lines.at(i));
+        if(line.isLabel==1 || (body!="" && body.at(0)=='.'))    {
+            known.clear();
+            pending.clear();
+            points = (line.isLabel==1) ? entry[i] : std::unordered_map<std::string,memoryRef>();
+            continue;
+        }
+        if(line.isInstruction==0)   {
+            continue;
+        }
+        if(line.opcode=="jal" || line.opcode=="jalr")   {   // the callee may read and write any memory but its own frame and clobbers the temporaries
+            known.clear();
+            pending.clear();
+            points.clear();
+            continue;
+        }
+        if(isBranch(line.opcode)==1)    {       // the target may read anything, the fall through keeps what is known
+            pending.clear();
+            continue;
+        }
+        int isStore=0;
+        int access = (slotAccess(line, isStore)!=0) ? 1 : 0;
+        memoryRef ref;
+        if(access==1)   {
+            ref = resolve(line, points);
+            ref.reg = line.operands.at(0);
+            ref.line = i;
+        }
+        if(access==1 && isStore==0)  {
+            std::string reg = line.operands.at(0);
+            std::string source = "";
+            for(long k=0;k<known.size();k++)    {
+                if(mustAlias(known.at(k), ref)==1 && ref.width>=4)  {
+                    source = known.at(k).reg;
+                }
+            }
+            if(source!="" && (reg.compare(0, 2, "$f")==0)!=(source.compare(0, 2, "$f")==0) && ref.width==8)   {
+                source = "";                        // no single move between a double and integer registers
+            }
+            if(source=="")  {                   // the load really reads memory
+                for(long k=pending.size()-1;k>=0;k--)   {
+                    if(mayAlias(pending.at(k), ref, escaped)==1)    {
+                        pending.erase(pending.begin()+k);
+                    }
+                }
+            }
+            else if(source==reg)    {
+                removed.at(i) = 1;
+                continue;
+            }
+            else    {
+                std::string move = (reg.compare(0, 2, "$f")==0) ? ((ref.width==8) ? "mov.d" : "mov.s") : "move";
+                if((reg.compare(0, 2, "$f")==0)!=(source.compare(0, 2, "$f")==0))   {
+                    move = (reg.compare(0, 2, "$f")==0) ? "mtc1" : "mfc1";
+                }
+                lines.at(i) = (move=="mtc1") ? move+" "+source+", "+reg : move+" "+reg+", "+source;
+                line = parseLine(lines.at(i));
+            }
+        }
+        if(access==1 && isStore==1) {
+            for(long k=known.size()-1;k>=0;k--) {
+                if(mayAlias(known.at(k), ref, escaped)==1)  {
+                    known.erase(known.begin()+k);
+                }
+            }
+            for(long k=pending.size()-1;k>=0;k--)   {   // overwritten before anything read it
+                if(covers(ref, pending.at(k))==1)   {
+                    removed.at(pending.at(k).line) = 1;
+                    pending.erase(pending.begin()+k);
+                }
+            }
+            if(inSlot==0 && ref.exact==1)   {   // a delay slot store also runs on the taken path
+                pending.push_back(ref);
+            }
+        }
+        std::vector<std::string> writes = writtenRegisters(line);
+        for(long k=known.size()-1;k>=0;k--) {
+            for(int j=0;j<writes.size();j++)    {
+                if(sameStorage(known.at(k).reg, writes.at(j))==1 || (known.at(k).kind==memoryRef::pointer && known.at(k).base==writes.at(j)) || writes.at(j)=="$sp")  {
+                    known.erase(known.begin()+k);
+                    break;
+                }
+            }
+        }
+        for(long k=pending.size()-1;k>=0;k--)   {   // the register no longer points where the store went
+            if(pending.at(k).kind==memoryRef::pointer && conflicts(writes, std::vector<std::string>(1, pending.at(k).base))==1)  {
+                pending.erase(pending.begin()+k);
+            }
+        }
+        trackAddress(line, points);
+        if(access==1 && ref.exact==1 && ref.reg!="$sp" && (isStore==1 || writes.size()==1) && !(ref.kind==memoryRef::pointer && ref.base==ref.reg))    {
+            ref.reg = line.operands.at(0);
+            known.push_back(ref);
+        }
+    }
+}
+
+static void removeDeadWrites(const std::vector<std::string> &lines, const std::vector<asmLine> &parsed, std::vector<int> &removed, long begin, long end)  {  // register results overwritten before any read
+    for(long i=begin+1;i<end;i++)   {
+        std::vector<std::string> reads;
+        std::vector<std::string> writes;
+        const asmLine &line = parsed.at(i);
+        int isStore=0;
+        if(removed.at(i)==1 || line.isInstruction==0 || registerUse(line, reads, writes)==0 || writes.size()!=1 || slotAccess(line, isStore)!=0)  {
+            continue;
+        }
+        if(parsed.at(i-1).isInstruction==1 && isBranch(parsed.at(i-1).opcode)==1)  {   // delay slot
+            continue;
+        }
+        std::string reg = writes.at(0);
+        if(reg=="$sp" || reg=="$gp" || reg=="$fp" || reg=="$ra" || reg=="$zero")   {
+            continue;
+        }
+        for(long j=i+1;j<end;j++)   {
+            const asmLine &next = parsed.at(j);
+            if(removed.at(j)==1 || (next.isInstruction==0 && next.isLabel==0 && trim(lines.at(j))==""))  {
+                continue;
+            }
+            if(next.isInstruction==0 || isBranch(next.opcode)==1)   {   // label or directive
+                break;
+            }
+            std::vector<std::string> nextReads;
+            std::vector<std::string> nextWrites;
+            if(registerUse(next, nextReads, nextWrites)==0) {
+                if(mentions(next, reg)==1)  {
+                    break;
+                }
+                continue;
+            }
+            if(conflicts(nextReads, writes)==1) {
+                break;
+            }
+            if(conflicts(nextWrites, writes)==1)    {
+                removed.at(i) = 1;
+                break;
+            }
+        }
+    }
+}
+
+void forwardMemory(std::vector<std::string> &lines)  {
+    std::vector<asmLine> parsed;
+    std::vector<int> removed(lines.size(), 0);
+    for(long i=0;i<lines.size();i++)    {
+        parsed.push_back(parseLine(lines.at(i)));
+    }
+    std::unordered_set<std::string> escaping = escapingLabels(lines, parsed);
+    long begin = 0;
+    for(long i=0;i<=lines.size();i++)   {       // one function at a time, between its .ent and .end
+        std::string body = (i<lines.size()) ? trim(lines.at(i)) : ".end";
+        if(body.compare(0, 4, ".ent")==0)   {
+            begin = i;
+        }
+        else if(body.compare(0, 4, ".end")==0 && i>begin)   {
+            std::unordered_map<long,std::unordered_map<std::string,memoryRef>> entry = pointsAtLabels(lines, parsed, begin, i, escaping);
+            forwardBlock(lines, parsed, removed, begin, i, escapedOffset(parsed, begin, i), entry);
+            removeDeadWrites(lines, parsed, removed, begin, i);
+            begin = i;
+        }
+    }
+    std::vector<std::string> kept;
+    for(long i=0;i<lines.size();i++)    {
+        if(removed.at(i)==0)    {
+            kept.push_back(lines.at(i));
+        }
+    }
+    lines = kept;
+}
+
+struct scheduleNode {           // instruction of a basic block being scheduled
+    long line=0;
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    int access=0;               // 1 for a load, 2 for a store
+    memoryRef ref;
+    int latency=1;              // cycles until the result may be used without a stall
+    int readsHiLo=0;
+    int writesHiLo=0;
+    std::vector<std::pair<long,int>> next;      // dependent node, cycles it has to wait
+    long waiting=0;             // predecessors not scheduled yet
+    long height=0;              // longest latency path to the end of the block
+    long earliest=0;            // first cycle its operands are ready
+};
+
+static std::string storageName(const std::string &reg)  {    // FP registers are dependent in even/odd pairs (doubles)
+    if(reg.size()>2 && reg.compare(0, 2, "$f")==0 && reg.find_first_not_of("0123456789", 2)==std::string::npos)  {
+        return "$f"+std::to_string(std::stol(reg.substr(2))&~1L);
+    }
+    return reg;
+}
+
+static int operandUse(const asmLine &line, std::vector<std::string> &reads, std::vector<std::string> &writes)   {  // returns 0 if the instruction must stay where it is
+    static const char *hiLoWriters[] = {"mult", "multu", "div", "divu", "madd", "maddu", "msub", "msubu", "mthi", "mtlo"};
+    static const char *fpOps[] = {"add.s", "add.d", "sub.s", "sub.d", "mul.s", "mul.d", "div.s", "div.d", "mov.s", "mov.d", "neg.s", "neg.d", "abs.s", "abs.d",
+                                  "sqrt.s", "sqrt.d", "cvt.s.d", "cvt.d.s", "cvt.s.w", "cvt.d.w", "cvt.w.s", "cvt.w.d", "trunc.w.s", "trunc.w.d"};
+    const std::vector<std::string> &ops = line.operands;
+    int isStore=0;
+    if(line.opcode=="nop" || isBranch(line.opcode)==1)  {
+        return 0;
+    }
+    if(slotAccess(line, isStore)!=0)    {
+        reads.push_back(baseRegister(ops.at(1)));
+        (isStore==1 ? reads : writes).push_back(storageName(ops.at(0)));
+        return 1;
+    }
+    if(registerUse(line, reads, writes)==1) {
+        return 1;
+    }
+    reads.clear();
+    writes.clear();
+    for(int i=0;i<sizeof(hiLoWriters)/sizeof(hiLoWriters[0]);i++)   {
+        if(line.opcode==hiLoWriters[i]) {
+            if(ops.size()==3)   {               // three operand macro: also moves the result out of LO
+                writes.push_back(ops.at(0));
+            }
+            for(int j=(ops.size()==3) ? 1 : 0;j<ops.size();j++) {
+                reads.push_back(ops.at(j));
+            }
+            writes.push_back("$hi");
+            writes.push_back("$lo");
+            return 1;
+        }
+    }
+    if((line.opcode=="mfhi" || line.opcode=="mflo") && ops.size()==1)   {
+        writes.push_back(ops.at(0));
+        reads.push_back((line.opcode=="mfhi") ? "$hi" : "$lo");
+        return 1;
+    }
+    if(line.opcode=="mul" && ops.size()==3) {   // MIPS32 mul leaves HI and LO undefined
+        writes.push_back(ops.at(0));
+        reads.push_back(ops.at(1));
+        reads.push_back(ops.at(2));
+        writes.push_back("$hi");
+        writes.push_back("$lo");
+        return 1;
+    }
+    if((line.opcode=="mtc1" || line.opcode=="mfc1") && ops.size()==2)   {
+        writes.push_back(storageName(ops.at(line.opcode=="mtc1" ? 1 : 0)));
+        reads.push_back(storageName(ops.at(line.opcode=="mtc1" ? 0 : 1)));
+        return 1;
+    }
+    if(line.opcode.compare(0, 2, "c.")==0 && ops.size()==2) {
+        reads.push_back(storageName(ops.at(0)));
+        reads.push_back(storageName(ops.at(1)));
+        writes.push_back("$fcc0");
+        return 1;
+    }
+    for(int i=0;i<sizeof(fpOps)/sizeof(fpOps[0]);i++)   {
+        if(line.opcode==fpOps[i] && ops.size()>=2)  {
+            writes.push_back(storageName(ops.at(0)));
+            for(int j=1;j<ops.size();j++)   {
+                reads.push_back(storageName(ops.at(j)));
+            }
+            return 1;
+        }
+    }
+    if((line.opcode=="li" || line.opcode=="la" || line.opcode=="lui") && ops.size()==2)  {
+        writes.push_back(ops.at(0));
+        return 1;
+    }
+    return 0;
+}
+
+static int latencyOf(const asmLine &line)   {   // result latency on a classic in-order MIPS pipeline
+    static const char *opcodes[] = {"mult", "multu", "mul", "div", "divu", "add.s", "add.d", "sub.s", "sub.d", "mul.s", "mul.d", "div.s", "div.d",
+                                    "cvt.s.d", "cvt.d.s", "cvt.s.w", "cvt.d.w", "cvt.w.s", "cvt.w.d", "c.eq.s", "c.eq.d", "c.lt.s", "c.lt.d", "c.le.s", "c.le.d"};
+    static const int cycles[] = {5, 5, 5, 35, 35, 4, 4, 4, 4, 4, 5, 12, 19,
+                                 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2};
+    int isStore=0;
+    if(slotAccess(line, isStore)!=0)    {
+        return (isStore==1) ? 1 : 2;        // one load delay cycle
+    }
+    if(line.opcode=="mtc1" || line.opcode=="mfc1")  {
+        return 2;
+    }
+    for(int i=0;i<sizeof(cycles)/sizeof(cycles[0]);i++) {
+        if(line.opcode==opcodes[i]) {
+            return cycles[i];
+        }
+    }
+    return 1;
+}
+
+static long hiLoHazards(const std::vector<scheduleNode> &nodes, const std::vector<long> &order, long sinceHiLo)  {   // HI/LO writes within two instructions of a read
+    long hazards=0;
+    for(long i=0;i<order.size();i++)    {
+        const scheduleNode &node = nodes.at(order.at(i));
+        if(node.writesHiLo==1 && sinceHiLo<2)   {
+            hazards++;
+        }
+        sinceHiLo = (node.readsHiLo==1) ? 0 : sinceHiLo+1;
+    }
+    return hazards;
+}
+
+static void scheduleRegion(std::vector<std::string> &lines, std::vector<asmLine> &parsed, std::vector<scheduleNode> &nodes, long escaped)   {
+    if(nodes.size()<3)  {
+        return;
+    }
+    long before=2;                      // instructions since the last mfhi/mflo ahead of the block
+    long seen=0;
+    for(long i=nodes.front().line-1;i>=0 && seen<2;i--) {
+        if(parsed.at(i).isInstruction==1)   {
+            if(parsed.at(i).opcode=="mfhi" || parsed.at(i).opcode=="mflo")  {
+                before = seen;
+                break;
+            }
+            seen++;
+        }
+    }
+    for(long i=0;i<nodes.size();i++)    {
+        for(long j=i+1;j<nodes.size();j++)  {
+            scheduleNode &a = nodes.at(i);
+            scheduleNode &b = nodes.at(j);
+            int wait=-1;
+            if(conflicts(a.writes, b.reads)==1) {
+                wait = a.latency;               // b reads a's result
+            }
+            else if(conflicts(a.writes, b.writes)==1)   {
+                wait = 1;
+            }
+            else if(a.readsHiLo==1 && b.writesHiLo==1)  {
+                wait = 3;                       // two other instructions between reading HI/LO and writing it again
+            }
+            else if(conflicts(a.reads, b.writes)==1 || (a.access!=0 && b.access!=0 && (a.access==2 || b.access==2) && mayAlias(a.ref, b.ref, escaped)==1))   {
+                wait = (a.access==2 && b.access==1) ? 1 : 0;
+            }
+            if(wait>=0) {
+                a.next.push_back(std::make_pair(j, wait));
+                b.waiting++;
+            }
+        }
+    }
+    for(long i=nodes.size()-1;i>=0;i--)  {
+        scheduleNode &node = nodes.at(i);
+        node.height = node.latency;
+        for(long k=0;k<node.next.size();k++)    {
+            node.height = std::max(node.height, node.next.at(k).second+nodes.at(node.next.at(k).first).height);
+        }
+    }
+    std::vector<long> order;
+    std::vector<int> done(nodes.size(), 0);
+    long cycle=0;
+    long sinceHiLo=before;
+    while(order.size()<nodes.size())    {
+        long best=-1;
+        int bestRank=-1;
+        for(long i=0;i<nodes.size();i++)    {
+            const scheduleNode &node = nodes.at(i);
+            if(done.at(i)==1 || node.waiting>0) {
+                continue;
+            }
+            int rank = (node.writesHiLo==1 && sinceHiLo<2) ? 0 : ((node.earliest<=cycle) ? 2 : 1);  // HI/LO may not be written within two instructions of a read
+            if(best<0 || rank>bestRank || (rank==bestRank && (rank==1 ? node.earliest<nodes.at(best).earliest || (node.earliest==nodes.at(best).earliest && node.height>nodes.at(best).height)
+                                                                     : node.height>nodes.at(best).height)))   {
+                best = i;
+                bestRank = rank;
+            }
+        }
+        scheduleNode &chosen = nodes.at(best);
+        cycle = std::max(cycle, chosen.earliest);
+        for(long k=0;k<chosen.next.size();k++)  {
+            scheduleNode &after = nodes.at(chosen.next.at(k).first);
+            after.waiting--;
+            after.earliest = std::max(after.earliest, cycle+chosen.next.at(k).second);
+        }
+        sinceHiLo = (chosen.readsHiLo==1) ? 0 : sinceHiLo+1;
+        cycle++;
+        done.at(best) = 1;
+        order.push_back(best);
+    }
+    std::vector<long> source;
+    for(long i=0;i<nodes.size();i++)    {
+        source.push_back(i);
+    }
+    if(hiLoHazards(nodes, order, before)>hiLoHazards(nodes, source, before))  {     // MIPS I-III: keep the reads and writes of HI/LO apart
+        return;
+    }
+    std::vector<std::string> text;
+    std::vector<asmLine> lineInfo;
+    for(long i=0;i<order.size();i++)    {
+        text.push_back(lines.at(nodes.at(order.at(i)).line));
+        lineInfo.push_back(parsed.at(nodes.at(order.at(i)).line));
+    }
+    for(long i=0;i<order.size();i++)    {
+        lines.at(nodes.at(i).line) = text.at(i);
+        parsed.at(nodes.at(i).line) = lineInfo.at(i);
+    }
+}
+
+void scheduleBlocks(std::vector<std::string> &lines)    {
+    std::vector<asmLine> parsed;
+    for(long i=0;i<lines.size();i++)    {
+        parsed.push_back(parseLine(lines.at(i)));
+    }
+    std::unordered_set<std::string> escaping = escapingLabels(lines, parsed);
+    long begin = 0;
+    for(long f=0;f<=lines.size();f++)   {       // one function at a time, between its .ent and .end
+        std::string fence = (f<lines.size()) ? trim(lines.at(f)) : ".end";
+        if(fence.compare(0, 4, ".ent")==0)  {
+            begin = f;
+            continue;
+        }
+        if(fence.compare(0, 4, ".end")!=0 || f<=begin)  {
+            continue;
+        }
+        std::unordered_map<long,std::unordered_map<std::string,memoryRef>> entry = pointsAtLabels(lines, parsed, begin, f, escaping);
+        long escaped = escapedOffset(parsed, begin, f);
+        std::unordered_map<std::string,memoryRef> points;
+        std::vector<scheduleNode> region;
+        int delaySlot=0;
+        for(long i=begin;i<=f;i++)  {
+            scheduleNode node;
+            const asmLine line = (i<f) ? parsed.at(i) : asmLine();
+            std::string body = (i<f) ? trim(lines.at(i)) : ".end";
+            int inSlot = delaySlot;
+            delaySlot = (line.isInstruction==1 && isBranch(line.opcode)==1) ? 1 : 0;
+            int movable = (line.isInstruction==1 && inSlot==0 && operandUse(line, node.reads, node.writes)==1) ? 1 : 0;
+            if(movable==1 && (conflicts(node.writes, std::vector<std::string>(1, "$sp"))==1 || conflicts(node.writes, std::vector<std::string>(1, "$gp"))==1))  {
+                movable = 0;                    // the frame and global pointers move only at the prologue and epilogue
+            }
+            if(movable==0)  {                   // block boundary: labels, directives, branches, calls and delay slots
+                scheduleRegion(lines, parsed, region, escaped);
+                region.clear();
+                if(line.isLabel==1) {
+                    points = entry[i];
+                }
+                else if(line.opcode=="jal" || line.opcode=="jalr" || (body!="" && body.at(0)=='.'))    {
+                    points.clear();
+                }
+                else if(line.isInstruction==1)  {
+                    trackAddress(line, points);
+                }
+                continue;
+            }
+            int isStore=0;
+            if(slotAccess(line, isStore)!=0)    {
+                node.access = (isStore==1) ? 2 : 1;
+                node.ref = resolve(line, points);
+            }
+            node.line = i;
+            node.latency = latencyOf(line);
+            node.readsHiLo = (line.opcode=="mfhi" || line.opcode=="mflo") ? 1 : 0;
+            node.writesHiLo = (conflicts(node.writes, std::vector<std::string>(1, "$lo"))==1 && node.readsHiLo==0) ? 1 : 0;
+            region.push_back(node);
+            trackAddress(line, points);
+        }
+        begin = f;
+    }
+}